@@ -0,0 +1,70 @@
+// Lights as binned by LightClusters, shared by the lit fragment shaders
+
+struct LightSource
+{
+    vec3 position;
+    int type;
+    vec3 direction;
+    float constant;
+    vec3 color;
+    float linear;
+    float quadratic;
+    float cutoff;
+    float outer_cutoff;
+};
+#define LIGHT_DIRECTIONAL 0
+#define LIGHT_POINT 1
+#define LIGHT_SPOT 2
+
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+};
+
+// lights binned in view space clusters by the renderer, directional lights lead light_indices
+layout (std140, binding = 1) uniform Clusters
+{
+    uvec4 cluster_grid;     // x, y, z, directional count
+    vec4 cluster_depth;     // near, far, slice scale, slice bias
+    vec4 cluster_screen;    // width, height
+};
+uniform usamplerBuffer lights_buffer;   // 4 texels per light
+uniform usamplerBuffer cluster_cells;   // offset, count in light_indices
+uniform usamplerBuffer light_indices;
+
+LightSource fetch_light(uint index)
+{
+    int texel = int(texelFetch(light_indices, int(index)).r) * 4;
+    uvec4 t0 = texelFetch(lights_buffer, texel);
+    uvec4 t1 = texelFetch(lights_buffer, texel + 1);
+    uvec4 t2 = texelFetch(lights_buffer, texel + 2);
+    uvec4 t3 = texelFetch(lights_buffer, texel + 3);
+
+    LightSource light;
+    light.position = uintBitsToFloat(t0.xyz);
+    light.type = int(t0.w);
+    light.direction = uintBitsToFloat(t1.xyz);
+    light.constant = uintBitsToFloat(t1.w);
+    light.color = uintBitsToFloat(t2.xyz);
+    light.linear = uintBitsToFloat(t2.w);
+    light.quadratic = uintBitsToFloat(t3.x);
+    light.cutoff = uintBitsToFloat(t3.y);
+    light.outer_cutoff = uintBitsToFloat(t3.z);
+    return light;
+}
+
+// offset and count of the lights of the cluster holding the fragment
+uvec2 get_cluster(vec3 world_pos)
+{
+    float depth = -(view * vec4(world_pos, 1.0)).z;
+    uvec2 tile = uvec2(clamp(gl_FragCoord.xy / cluster_screen.xy, 0.0, 0.999) * vec2(cluster_grid.xy));
+    uint slice = uint(clamp(log(depth) * cluster_depth.z - cluster_depth.w, 0.0, float(cluster_grid.z - 1)));
+    return texelFetch(cluster_cells, int(tile.x + cluster_grid.x * (tile.y + cluster_grid.y * slice))).xy;
+}
+
+// directional lights first, then the lights of the cluster
+uint get_light_index(uvec2 cluster, uint i)
+{
+    return i < cluster_grid.w ? i : cluster.x + i - cluster_grid.w;
+}
@@ -0,0 +1,13 @@
+// Material maps : the material picks a variant defining HAS_<NAME> for every texture it has,
+// without it the shader reads default_value and the sampler is compiled out
+struct Texture2D_RGB
+{
+    sampler2D value;
+    vec3 default_value;
+};
+
+struct Texture2D_R
+{
+    sampler2D value;
+    float default_value;
+};
@@ -11,19 +11,7 @@ in VS_OUT
 } vs_out;
 
 // material parameters
-struct Texture2D_RGB
-{
-    sampler2D value;
-    int set;
-    vec3 default_value;
-};
-
-struct Texture2D_R
-{
-    sampler2D value;
-    int set;
-    float default_value;
-};
+#include "include/textures.glsl"
 
 uniform Texture2D_RGB albedo_tex;
 uniform Texture2D_RGB normal_tex;
@@ -32,27 +20,7 @@ uniform Texture2D_R roughness_tex;
 uniform Texture2D_R ao_tex;
 
 // lights
-struct LightSource
-{
-    vec3 position;
-    int type;
-    vec3 direction;
-    float constant;
-    vec3 color;
-    float linear;
-    float quadratic;
-    float cutoff;
-    float outer_cutoff;
-};
-#define LIGHTS_COUNT_MAX 20
-#define LIGHT_DIRECTIONAL 0
-#define LIGHT_POINT 1
-#define LIGHT_SPOT 2
-layout (std140, binding = 1) uniform Lights
-{
-    LightSource lights_sources[LIGHTS_COUNT_MAX];
-};
-uniform int lights_count;
+#include "include/lights.glsl"
 
 uniform vec3 camPos;
 
@@ -62,6 +30,7 @@ const float PI = 3.14159265359;
 // Don't worry if you don't get what's going on; you generally want to do normal 
 // mapping the usual way for performance anways; I do plan make a note of this 
 // technique somewhere later in the normal mapping tutorial.
+#ifdef HAS_NORMAL_TEX
 vec3 getNormalFromMap()
 {
     vec3 tangentNormal = texture(normal_tex.value, vs_out.TexCoords).xyz * 2.0 - 1.0;
@@ -78,6 +47,7 @@ vec3 getNormalFromMap()
 
     return normalize(TBN * tangentNormal);
 }
+#endif
 // ----------------------------------------------------------------------------
 float DistributionGGX(vec3 N, vec3 H, float roughness)
 {
@@ -121,16 +91,32 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0)
 // ----------------------------------------------------------------------------
 void main()
 {		
-    vec3 albedo = albedo_tex.set * pow(texture(albedo_tex.value, vs_out.TexCoords).rgb, vec3(2.2)) - (albedo_tex.set - 1) * albedo_tex.default_value;
-    float metallic = metallic_tex.set * texture(metallic_tex.value, vs_out.TexCoords).r - (metallic_tex.set - 1) * metallic_tex.default_value;
-    float roughness = roughness_tex.set * texture(roughness_tex.value, vs_out.TexCoords).r - (roughness_tex.set - 1) * roughness_tex.default_value;
-    float ao = ao_tex.set * texture(ao_tex.value, vs_out.TexCoords).r - (ao_tex.set - 1) * ao_tex.default_value;
-
+#ifdef HAS_ALBEDO_TEX
+    vec3 albedo = pow(texture(albedo_tex.value, vs_out.TexCoords).rgb, vec3(2.2));
+#else
+    vec3 albedo = albedo_tex.default_value;
+#endif
+#ifdef HAS_METALLIC_TEX
+    float metallic = texture(metallic_tex.value, vs_out.TexCoords).r;
+#else
+    float metallic = metallic_tex.default_value;
+#endif
+#ifdef HAS_ROUGHNESS_TEX
+    float roughness = texture(roughness_tex.value, vs_out.TexCoords).r;
+#else
+    float roughness = roughness_tex.default_value;
+#endif
+#ifdef HAS_AO_TEX
+    float ao = texture(ao_tex.value, vs_out.TexCoords).r;
+#else
+    float ao = ao_tex.default_value;
+#endif
+
+#ifdef HAS_NORMAL_TEX
+    vec3 N = getNormalFromMap();
+#else
     vec3 N = normalize(vs_out.Normal);
-    if (normal_tex.set > 0)
-    {
-        N = getNormalFromMap();
-    }
+#endif
     vec3 V = normalize(camPos - vs_out.WorldPos);
 
     // calculate reflectance at normal incidence; if dia-electric (like plastic) use F0 
@@ -140,30 +126,33 @@ void main()
 
     // reflectance equation
     vec3 Lo = vec3(0.0);
-    for(int i = 0; i < lights_count; ++i) 
+    uvec2 cluster = get_cluster(vs_out.WorldPos);
+    uint lights_count = cluster_grid.w + cluster.y;
+    for(uint i = 0; i < lights_count; ++i) 
     {
-        vec3 L = normalize(lights_sources[i].position - vs_out.WorldPos);
+        LightSource light = fetch_light(get_light_index(cluster, i));
+        vec3 L = normalize(light.position - vs_out.WorldPos);
         vec3 H = normalize(V + L);
-        float distance = length(lights_sources[i].position - vs_out.WorldPos);
+        float distance = length(light.position - vs_out.WorldPos);
         
         float attenuation = 1.0;
         float intensity = 1.0;
 
         // attenuation
-        if (lights_sources[i].type >= LIGHT_POINT)
+        if (light.type >= LIGHT_POINT)
         {
-            attenuation = 1.0 / (lights_sources[i].constant + lights_sources[i].linear * distance + lights_sources[i].quadratic * (distance * distance));    
+            attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
         }
         // spot light intensity
-        if (lights_sources[i].type == LIGHT_SPOT)
+        if (light.type == LIGHT_SPOT)
         {
-            float theta = dot(L, normalize(-lights_sources[i].direction)); 
-            float epsilon = lights_sources[i].cutoff - lights_sources[i].outer_cutoff;
-            intensity = clamp((theta - lights_sources[i].outer_cutoff) / epsilon, 0.0, 1.0);
+            float theta = dot(L, normalize(-light.direction)); 
+            float epsilon = light.cutoff - light.outer_cutoff;
+            intensity = clamp((theta - light.outer_cutoff) / epsilon, 0.0, 1.0);
         }
 
         // radiance
-        vec3 radiance = lights_sources[i].color * attenuation * intensity;
+        vec3 radiance = light.color * attenuation * intensity;
 
         // calculate per-light radiance
         // vec3 L = normalize(lightPositions[i] - vs_out.WorldPos);
@@ -48,41 +48,9 @@
 
 // uniform SpotLight spot_light;
 
-struct LightSource
-{
-    vec3 position;
-    int type;
-    vec3 direction;
-    float constant;
-    vec3 color;
-    float linear;
-    float quadratic;
-    float cutoff;
-    float outer_cutoff;
-};
-#define LIGHTS_COUNT_MAX 20
-#define LIGHT_DIRECTIONAL 0
-#define LIGHT_POINT 1
-#define LIGHT_SPOT 2
-layout (std140, binding = 1) uniform Lights
-{
-    LightSource lights_sources[LIGHTS_COUNT_MAX];
-};
-uniform int lights_count;
-
-struct Texture2D_RGB
-{
-    sampler2D value;
-    int set;
-    vec3 default_value;
-};
+#include "include/lights.glsl"
 
-struct Texture2D_R
-{
-    sampler2D value;
-    int set;
-    float default_value;
-};
+#include "include/textures.glsl"
 
 uniform Texture2D_RGB diffuse_tex;
 uniform Texture2D_RGB normal_tex;
@@ -119,6 +87,7 @@ in VS_OUT
     vec2 TexCoords;
 } fs_in;
 
+#ifdef HAS_NORMAL_TEX
 vec3 getNormalFromMap()
 {
     vec3 tangentNormal = texture(normal_tex.value, fs_in.TexCoords).xyz * 2.0 - 1.0;
@@ -135,6 +104,7 @@ vec3 getNormalFromMap()
 
     return normalize(TBN * tangentNormal);
 }
+#endif
 
 vec3 compute_directional_light(LightSource light, vec3 normal, vec3 viewDir, vec3 material_diffuse, vec3 material_specular, float shininess);
 vec3 compute_point_light(LightSource light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 material_diffuse, vec3 material_specular, float shininess);
@@ -144,16 +114,32 @@ void main()
 {
     // normal
 
+#ifdef HAS_NORMAL_TEX
+    vec3 norm = getNormalFromMap();
+#else
     vec3 norm = normalize(fs_in.Normal);
-    if (normal_tex.set > 0)
-    {
-        norm = getNormalFromMap();
-    }
-
-    vec3 diffuse = diffuse_tex.set * texture(diffuse_tex.value, fs_in.TexCoords).rgb - (diffuse_tex.set - 1) * diffuse_tex.default_value;
-    vec3 ambient = ambient_tex.set * texture(ambient_tex.value, fs_in.TexCoords).rgb - (ambient_tex.set - 1) * ambient_tex.default_value;
-    vec3 specular = specular_tex.set * texture(specular_tex.value, fs_in.TexCoords).rgb - (specular_tex.set - 1) * specular_tex.default_value;
-    float shininess = shininess_tex.set * texture(shininess_tex.value, fs_in.TexCoords).r - (shininess_tex.set - 1) * shininess_tex.default_value;
+#endif
+
+#ifdef HAS_DIFFUSE_TEX
+    vec3 diffuse = texture(diffuse_tex.value, fs_in.TexCoords).rgb;
+#else
+    vec3 diffuse = diffuse_tex.default_value;
+#endif
+#ifdef HAS_AMBIENT_TEX
+    vec3 ambient = texture(ambient_tex.value, fs_in.TexCoords).rgb;
+#else
+    vec3 ambient = ambient_tex.default_value;
+#endif
+#ifdef HAS_SPECULAR_TEX
+    vec3 specular = texture(specular_tex.value, fs_in.TexCoords).rgb;
+#else
+    vec3 specular = specular_tex.default_value;
+#endif
+#ifdef HAS_SHININESS_TEX
+    float shininess = texture(shininess_tex.value, fs_in.TexCoords).r;
+#else
+    float shininess = shininess_tex.default_value;
+#endif
 
     // diffuse
     // vec3 diffuse = diffuse_default;
@@ -187,19 +173,22 @@ void main()
 
     vec3 result = vec3(0,0,0);
 
-     for(int i = 0; i < lights_count; i++)
+    uvec2 cluster = get_cluster(fs_in.WorldPos);
+    uint lights_count = cluster_grid.w + cluster.y;
+    for(uint i = 0; i < lights_count; i++)
     {
-        if (lights_sources[i].type == LIGHT_DIRECTIONAL)
+        LightSource light = fetch_light(get_light_index(cluster, i));
+        if (light.type == LIGHT_DIRECTIONAL)
         {
-            result += compute_directional_light(lights_sources[i], norm, viewDir, diffuse, specular, shininess);
+            result += compute_directional_light(light, norm, viewDir, diffuse, specular, shininess);
         }
-        else if (lights_sources[i].type == LIGHT_POINT)
+        else if (light.type == LIGHT_POINT)
         {
-            result += compute_point_light(lights_sources[i], norm, fs_in.WorldPos, viewDir, diffuse, specular, shininess);
+            result += compute_point_light(light, norm, fs_in.WorldPos, viewDir, diffuse, specular, shininess);
         }
-        else if (lights_sources[i].type == LIGHT_SPOT)
+        else if (light.type == LIGHT_SPOT)
         {
-            result += compute_spot_light(lights_sources[i], norm, fs_in.WorldPos, viewDir, diffuse, specular, shininess);
+            result += compute_spot_light(light, norm, fs_in.WorldPos, viewDir, diffuse, specular, shininess);
         }
     }
 
@@ -2,6 +2,9 @@
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 tex_coords;
 layout (location = 2) in vec3 normal;
+// per instance, filled by the renderer
+layout (location = 3) in mat4 model;
+layout (location = 7) in mat3 normal_matrix;
 
 
 out VS_OUT
@@ -18,13 +21,11 @@ layout (std140, binding = 0) uniform Camera
     mat4 projection;
 };
 
-uniform mat4 model;
-
 void main()
 {
     gl_Position = projection * view * model * vec4(position, 1.0f);
 
     vs_out.WorldPos = vec3(model * vec4(position, 1.0));
-    vs_out.Normal = mat3(transpose(inverse(model))) * normal;
+    vs_out.Normal = normal_matrix * normal;
     vs_out.TexCoords = tex_coords;
 }
\ No newline at end of file
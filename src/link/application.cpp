@@ -7,6 +7,8 @@
 
 #include <cstdio>
 #include <thread>
+#include <chrono>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <memory>
@@ -24,6 +26,7 @@
 #include "file.hpp"
 #include "file_system.hpp"
 #include "timer.hpp"
+#include "job_system.hpp"
 #include "window.hpp"
 #include "editor/editor.hpp"
 #include "gfx/debug.hpp"
@@ -32,6 +35,7 @@
 #include "terrain.hpp"
 #include "diamond_square.hpp"
 #include "gfx/shader.hpp"
+#include "gfx/shader_compiler.hpp"
 #include "gfx/camera.hpp"
 #include "gfx/framebuffer.hpp"
 #include "gfx/texture_2d.hpp"
@@ -51,6 +55,7 @@
 #include "voxel/volume_data.hpp"
 #include "voxel/surface_extractor.hpp"
 #include "data_root.hpp"
+#include "config.hpp"
 
 #include <imgui.h>
 
@@ -58,6 +63,8 @@
 using namespace link;
 
 
+int run_headless(const std::string& data_root);
+
 #ifdef LINK_EDITOR_ENABLED
 void debug_draw(FileSystem* file_system);
 #else
@@ -67,8 +74,10 @@ void debug_draw(FileSystem* file_system) {}
 
 //btAlignedObjectArray<btCollisionShape*> collisionShapes;
 
-int main()
+int main(int argc, char** argv)
 {
+    LINK_CONFIG->parse(argc, argv);
+
     if (!std::filesystem::is_directory(LINK_DATA_ROOT))
     {
         fmt::print("LINK_PATH_ROOT is not correct. Check that data directory is at the right location,\nand that the value in data_root.hpp is correct.\nCurrent value: {0}\nPress enter to exit...", LINK_DATA_ROOT);
@@ -83,12 +92,20 @@ int main()
 
     std::string data_root = std::string(LINK_DATA_ROOT);
     LINK_TIME->start();
+    LINK_TIME->simulation.set_rate(LINK_CONFIG->tick_rate);
+    LINK_JOBS->init();
     CRandom::initialize();
 
+    if (LINK_CONFIG->headless)
+    {
+        return run_headless(data_root);
+    }
+
     FileSystem file_system;
     file_system.init(data_root);
 
     LINK_WINDOW->init({ 1980, 1080 });
+    LINK_SHADER_COMPILER->init(LINK_WINDOW->window, LINK_WINDOW->gl_context);
     LINK_EDITOR->init();
     LINK_DEBUG->init();
 
@@ -128,6 +145,7 @@ int main()
         LINK_INPUT->mouse.wheel = MouseWheel::NONE;
 
         done = LINK_WINDOW->poll_events();
+        LINK_SHADER_COMPILER->update();
 
         if (LINK_INPUT->is_down(SDL_SCANCODE_ESCAPE))
         {
@@ -153,6 +171,7 @@ int main()
         LINK_EDITOR->begin_frame();
 
         LINK_GAME->debug_draw();
+        LINK_RENDERER->debug_draw();
 
         debug_draw(&file_system);
 
@@ -184,13 +203,69 @@ int main()
     }
 
     LINK_PHYSICS->shutdown();
+    LINK_JOBS->shutdown();
 
     LINK_EDITOR->shutdown();
+    LINK_SHADER_COMPILER->shutdown();
     LINK_WINDOW->shutdown();
 
     return 0;
 }
 
+// Simulation only : no window, gl context, editor nor debug draw.
+// Scenes are fully loaded then played at a fixed tick rate, the cost of each tick is reported at exit.
+int run_headless(const std::string& data_root)
+{
+    const Config* config = LINK_CONFIG;
+    const f64 tick_ms = 1000.0 / config->tick_rate;
+
+    fmt::print("Headless simulation at {} ticks per second\n", config->tick_rate);
+
+    LINK_PHYSICS->init();
+
+    LINK_GAME->init(data_root + "scenes/");
+    while (LINK_GAME->loader.is_loading())
+    {
+        LINK_GAME->update();
+        std::this_thread::yield();
+    }
+    LINK_GAME->play();
+
+    const f64 frequency = (f64)SDL_GetPerformanceFrequency();
+    f64 busy_ms = 0.0;
+    f64 worst_ms = 0.0;
+    u64 ticks = 0;
+
+    while (config->max_ticks == 0 || ticks < config->max_ticks)
+    {
+        const u64 begin = SDL_GetPerformanceCounter();
+
+        LINK_TIME->update();
+        LINK_GAME->update();
+
+        const f64 elapsed_ms = (SDL_GetPerformanceCounter() - begin) * 1000.0 / frequency;
+        busy_ms += elapsed_ms;
+        worst_ms = std::max(worst_ms, elapsed_ms);
+        ticks++;
+
+        if (!config->unthrottled && elapsed_ms < tick_ms)
+        {
+            std::this_thread::sleep_for(std::chrono::duration<f64, std::milli>(tick_ms - elapsed_ms));
+        }
+    }
+
+    if (ticks > 0)
+    {
+        fmt::print("{} ticks, {:.3f} ms per tick on average, {:.3f} ms worst\n", ticks, busy_ms / ticks, worst_ms);
+    }
+
+    LINK_GAME->stop();
+    LINK_PHYSICS->shutdown();
+    LINK_JOBS->shutdown();
+
+    return 0;
+}
+
 
 #ifdef LINK_EDITOR_ENABLED
 void debug_draw(FileSystem* file_system)
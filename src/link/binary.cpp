@@ -0,0 +1,128 @@
+#include "binary.hpp"
+
+#include <fmt/ostream.h>
+
+namespace link
+{
+    void BinaryWriter::write_bytes(const void* data, u32 size)
+    {
+        const u8* bytes = (const u8*)data;
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    void BinaryWriter::write_string(std::string_view value)
+    {
+        write(intern(value));
+    }
+
+    u32 BinaryWriter::intern(std::string_view value)
+    {
+        std::string key(value);
+        auto it = string_indices.find(key);
+        if (it == string_indices.end())
+        {
+            it = string_indices.emplace(key, (u32)strings.size()).first;
+            strings.emplace_back(std::move(key));
+        }
+        return it->second;
+    }
+
+    void BinaryWriter::write_string_table(std::vector<u8>& out) const
+    {
+        const u32 count = (u32)strings.size();
+        const u32 entries_size = sizeof(u32) + count * 2 * sizeof(u32);
+
+        u32 characters_size = 0;
+        for (const std::string& string : strings)
+        {
+            characters_size += (u32)string.size() + 1;
+        }
+
+        const u32 start = (u32)out.size();
+        out.resize(start + entries_size + characters_size);
+        u8* table = &out[start];
+
+        std::memcpy(table, &count, sizeof(u32));
+        u32 offset = entries_size;
+        for (u32 i = 0; i < count; ++i)
+        {
+            const u32 length = (u32)strings[i].size();
+            std::memcpy(table + sizeof(u32) + i * 2 * sizeof(u32), &offset, sizeof(u32));
+            std::memcpy(table + sizeof(u32) + i * 2 * sizeof(u32) + sizeof(u32), &length, sizeof(u32));
+            std::memcpy(table + offset, strings[i].c_str(), length + 1);
+            offset += length + 1;
+        }
+    }
+
+    BinaryReader::BinaryReader(const u8* data, u32 size, const BinaryReader* string_table)
+        : data(data)
+        , size(size)
+        , cursor(0)
+        , failed(false)
+        , string_table(string_table)
+        , string_count(0)
+    {
+    }
+
+    const u8* BinaryReader::read_bytes(u32 count)
+    {
+        if (failed || count > size - cursor)
+        {
+            if (!failed)
+            {
+                fmt::print("BinaryReader : reading {} bytes past the end of a {} bytes buffer\n", count, size);
+            }
+            failed = true;
+            return nullptr;
+        }
+
+        const u8* bytes = data + cursor;
+        cursor += count;
+        return bytes;
+    }
+
+    std::string_view BinaryReader::read_string()
+    {
+        const u32 index = read<u32>();
+        if (failed || !string_table)
+        {
+            return {};
+        }
+        return string_table->get_string(index);
+    }
+
+    bool BinaryReader::init_string_table(const u8* table_data, u32 table_size)
+    {
+        data = table_data;
+        size = table_size;
+        cursor = 0;
+        failed = false;
+
+        string_count = read<u32>();
+        if (failed || (u64)string_count * 2 * sizeof(u32) > get_remaining())
+        {
+            failed = true;
+            string_count = 0;
+            return false;
+        }
+        return true;
+    }
+
+    std::string_view BinaryReader::get_string(u32 index) const
+    {
+        if (index >= string_count)
+        {
+            return {};
+        }
+
+        u32 offset;
+        u32 length;
+        std::memcpy(&offset, data + sizeof(u32) + index * 2 * sizeof(u32), sizeof(u32));
+        std::memcpy(&length, data + sizeof(u32) + index * 2 * sizeof(u32) + sizeof(u32), sizeof(u32));
+        if ((u64)offset + length >= size)
+        {
+            return {};
+        }
+        return std::string_view((const char*)data + offset, length);
+    }
+}
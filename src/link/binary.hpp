@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <type_traits>
+#include <cstring>
+#include <glm/glm.hpp>
+
+#include "types.hpp"
+
+namespace link
+{
+    // Appends plain values to a byte buffer. Strings are interned in a table written separately,
+    // the stream itself only holds their index.
+    struct BinaryWriter
+    {
+        template<typename T>
+        void write(const T& value);
+
+        void write_bytes(const void* data, u32 size);
+        void write_string(std::string_view value);
+        u32 intern(std::string_view value);
+
+        // serialized string table : u32 count, count * (u32 offset, u32 length), then the null terminated characters
+        void write_string_table(std::vector<u8>& out) const;
+
+        inline u32 get_position() const { return (u32)buffer.size(); }
+
+        template<typename T>
+        void patch(u32 position, const T& value);
+
+        std::vector<u8> buffer;
+        std::vector<std::string> strings;
+        std::unordered_map<std::string, u32> string_indices;
+    };
+
+    // Reads values back from memory it does not own (a mapped file, a snapshot), strings are returned as views.
+    // Reading past the end sets failed and returns zeroed values instead of touching memory out of range.
+    struct BinaryReader
+    {
+        BinaryReader(const u8* data = nullptr, u32 size = 0, const BinaryReader* string_table = nullptr);
+
+        template<typename T>
+        T read();
+
+        template<typename T>
+        void read(T& value) { value = read<T>(); }
+
+        const u8* read_bytes(u32 size);
+        std::string_view read_string();
+
+        // reader over a string table written by BinaryWriter::write_string_table
+        bool init_string_table(const u8* data, u32 size);
+        std::string_view get_string(u32 index) const;
+
+        inline u32 get_remaining() const { return size - cursor; }
+
+        const u8* data;
+        u32 size;
+        u32 cursor;
+        bool failed;
+
+        const BinaryReader* string_table;
+        u32 string_count;
+    };
+
+    template<typename T>
+    void BinaryWriter::write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written as is");
+        write_bytes(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void BinaryWriter::patch(u32 position, const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written as is");
+        std::memcpy(&buffer[position], &value, sizeof(T));
+    }
+
+    template<typename T>
+    T BinaryReader::read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read as is");
+
+        T value{};
+        if (const u8* bytes = read_bytes(sizeof(T)))
+        {
+            std::memcpy(&value, bytes, sizeof(T));
+        }
+        return value;
+    }
+}
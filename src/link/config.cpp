@@ -0,0 +1,42 @@
+#include "config.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fmt/ostream.h>
+
+namespace link
+{
+    void Config::parse(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if (std::strcmp(arg, "--headless") == 0)
+            {
+                headless = true;
+            }
+            else if (std::strcmp(arg, "--unthrottled") == 0)
+            {
+                unthrottled = true;
+            }
+            else if (std::strcmp(arg, "--tick-rate") == 0 && has_value)
+            {
+                const f32 value = (f32)std::atof(argv[++i]);
+                if (value > 0.0f)
+                {
+                    tick_rate = value;
+                }
+            }
+            else if (std::strcmp(arg, "--ticks") == 0 && has_value)
+            {
+                max_ticks = std::strtoull(argv[++i], nullptr, 10);
+            }
+            else
+            {
+                fmt::print("Unknown argument {}\n", arg);
+            }
+        }
+    }
+}
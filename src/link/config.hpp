@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+#include "types.hpp"
+#include "singleton.hpp"
+
+namespace link
+{
+    // Run options from the command line :
+    //  --headless          no window, no gl context, no editor : scenes are loaded and simulated only,
+    //                      rendering components keep their data but never touch the renderer
+    //  --tick-rate <hz>    fixed simulation rate, 60 by default, the headless loop ticks at that rate
+    //  --ticks <count>     stops the headless loop after count ticks, 0 (default) runs until killed
+    //  --unthrottled       headless ticks run back to back instead of waiting for the next tick
+    struct Config : Singleton<Config>
+    {
+        void parse(int argc, char** argv);
+
+        bool headless = false;
+        bool unthrottled = false;
+        f32 tick_rate = 60.0f;
+        u64 max_ticks = 0;
+    };
+}
+
+#define LINK_CONFIG link::Config::get()
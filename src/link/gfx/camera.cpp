@@ -71,6 +71,11 @@ namespace link
         update_view();
     }
 
+    Frustum Camera::get_frustum() const
+    {
+        return Frustum::from_matrix(projection * view);
+    }
+
     void Camera::update_view()
     {
         view = glm::lookAt(position, position + front, up);
@@ -80,7 +85,7 @@ namespace link
 
     void Camera::update_projection(const glm::vec2& scene_render_size)
     {
-        projection = glm::perspective(glm::radians(45.0f), scene_render_size.x / scene_render_size.y, 0.1f, 10000.0f);
+        projection = glm::perspective(glm::radians(45.0f), scene_render_size.x / scene_render_size.y, Renderer::NEAR_PLANE, Renderer::FAR_PLANE);
         ubo.set_data(sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(projection));
     }
 
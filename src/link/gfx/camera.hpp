@@ -31,5 +31,6 @@ namespace link
 
 
         Ray screen_to_world();
+        Frustum get_frustum() const;
     };
 }
\ No newline at end of file
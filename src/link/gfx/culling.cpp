@@ -0,0 +1,146 @@
+#include "culling.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define LINK_CULLING_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace link
+{
+    void CullingSet::resize(u32 count)
+    {
+        const u32 padded = (count + BATCH_SIZE - 1) / BATCH_SIZE * BATCH_SIZE;
+
+        // padding lanes are empty boxes at the origin, their result is never read
+        for (std::vector<f32>* array : { &center_x, &center_y, &center_z, &extents_x, &extents_y, &extents_z, &sphere_x, &sphere_y, &sphere_z, &sphere_radius })
+        {
+            array->assign(padded, 0.0f);
+        }
+    }
+
+    void CullingSet::set(u32 index, const AABB& box, const Sphere& sphere)
+    {
+        const glm::vec3 center = box.center();
+        const glm::vec3 extents = box.extents();
+        center_x[index] = center.x;
+        center_y[index] = center.y;
+        center_z[index] = center.z;
+        extents_x[index] = extents.x;
+        extents_y[index] = extents.y;
+        extents_z[index] = extents.z;
+        sphere_x[index] = sphere.center.x;
+        sphere_y[index] = sphere.center.y;
+        sphere_z[index] = sphere.center.z;
+        sphere_radius[index] = sphere.radius;
+    }
+
+    AABB CullingSet::get(u32 index) const
+    {
+        const glm::vec3 center(center_x[index], center_y[index], center_z[index]);
+        const glm::vec3 extents(extents_x[index], extents_y[index], extents_z[index]);
+        return { center - extents, center + extents };
+    }
+
+#ifdef LINK_CULLING_SSE
+    void CullingSet::cull(const Frustum& frustum, u32 first, u32 end, u8* visible) const
+    {
+        end = std::min(end, get_padded_count());
+
+        const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+        __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+        __m128 abs_x[6], abs_y[6], abs_z[6];
+        for (u32 p = 0; p < 6; ++p)
+        {
+            plane_x[p] = _mm_set1_ps(frustum.planes[p].x);
+            plane_y[p] = _mm_set1_ps(frustum.planes[p].y);
+            plane_z[p] = _mm_set1_ps(frustum.planes[p].z);
+            plane_w[p] = _mm_set1_ps(frustum.planes[p].w);
+            abs_x[p] = _mm_andnot_ps(sign_mask, plane_x[p]);
+            abs_y[p] = _mm_andnot_ps(sign_mask, plane_y[p]);
+            abs_z[p] = _mm_andnot_ps(sign_mask, plane_z[p]);
+        }
+
+        for (u32 i = first; i < end; i += BATCH_SIZE)
+        {
+            // sphere fully behind a plane : outside, in front of all of them : inside, either way the box is not needed
+            const __m128 sx = _mm_loadu_ps(&sphere_x[i]);
+            const __m128 sy = _mm_loadu_ps(&sphere_y[i]);
+            const __m128 sz = _mm_loadu_ps(&sphere_z[i]);
+            const __m128 sr = _mm_loadu_ps(&sphere_radius[i]);
+            const __m128 negative_sr = _mm_xor_ps(sr, sign_mask);
+            __m128 outside = _mm_setzero_ps();
+            __m128 inside = _mm_cmpeq_ps(sr, sr);
+            for (u32 p = 0; p < 6; ++p)
+            {
+                const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], sx), _mm_mul_ps(plane_y[p], sy)), _mm_add_ps(_mm_mul_ps(plane_z[p], sz), plane_w[p]));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negative_sr));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, sr));
+            }
+
+            if (_mm_movemask_ps(_mm_or_ps(outside, inside)) != 0xF)
+            {
+                const __m128 cx = _mm_loadu_ps(&center_x[i]);
+                const __m128 cy = _mm_loadu_ps(&center_y[i]);
+                const __m128 cz = _mm_loadu_ps(&center_z[i]);
+                const __m128 ex = _mm_loadu_ps(&extents_x[i]);
+                const __m128 ey = _mm_loadu_ps(&extents_y[i]);
+                const __m128 ez = _mm_loadu_ps(&extents_z[i]);
+
+                // a box is outside as soon as it is fully behind one plane : distance + projected radius < 0
+                for (u32 p = 0; p < 6; ++p)
+                {
+                    const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], cx), _mm_mul_ps(plane_y[p], cy)), _mm_add_ps(_mm_mul_ps(plane_z[p], cz), plane_w[p]));
+                    const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_x[p], ex), _mm_mul_ps(abs_y[p], ey)), _mm_mul_ps(abs_z[p], ez));
+                    outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+                }
+            }
+
+            const int mask = _mm_movemask_ps(outside);
+            visible[i + 0] = (mask & 1) ? 0 : 1;
+            visible[i + 1] = (mask & 2) ? 0 : 1;
+            visible[i + 2] = (mask & 4) ? 0 : 1;
+            visible[i + 3] = (mask & 8) ? 0 : 1;
+        }
+    }
+#else
+    void CullingSet::cull(const Frustum& frustum, u32 first, u32 end, u8* visible) const
+    {
+        end = std::min(end, get_padded_count());
+
+        for (u32 i = first; i < end; ++i)
+        {
+            // sphere fully behind a plane : outside, in front of all of them : inside, either way the box is not needed
+            bool sphere_inside = true;
+            bool sphere_outside = false;
+            for (const glm::vec4& plane : frustum.planes)
+            {
+                const f32 distance = plane.x * sphere_x[i] + plane.y * sphere_y[i] + plane.z * sphere_z[i] + plane.w;
+                sphere_outside |= distance < -sphere_radius[i];
+                sphere_inside &= distance >= sphere_radius[i];
+            }
+            if (sphere_outside || sphere_inside)
+            {
+                visible[i] = sphere_inside && !sphere_outside;
+                continue;
+            }
+
+            u8 inside = 1;
+            for (const glm::vec4& plane : frustum.planes)
+            {
+                const f32 distance = plane.x * center_x[i] + plane.y * center_y[i] + plane.z * center_z[i] + plane.w;
+                const f32 radius = std::abs(plane.x) * extents_x[i] + std::abs(plane.y) * extents_y[i] + std::abs(plane.z) * extents_z[i];
+                if (distance + radius < 0.0f)
+                {
+                    inside = 0;
+                    break;
+                }
+            }
+            visible[i] = inside;
+        }
+    }
+#endif
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+
+#include "link/types.hpp"
+#include "link/physics/shapes.hpp"
+
+namespace link
+{
+    // World space boxes and bounding spheres in structure of arrays form, padded to a multiple of BATCH_SIZE
+    // so the frustum test runs on BATCH_SIZE objects at once without a scalar tail.
+    // Spheres are tested first, the boxes only for the objects a sphere leaves crossing a plane.
+    struct CullingSet
+    {
+        static constexpr u32 BATCH_SIZE = 4;
+
+        void resize(u32 count);
+        void set(u32 index, const AABB& box, const Sphere& sphere);
+        AABB get(u32 index) const;
+
+        // visible[i] is 1 when object i is at least partly inside the frustum, 0 otherwise
+        // first has to be a multiple of BATCH_SIZE, end is clamped to the padded size
+        void cull(const Frustum& frustum, u32 first, u32 end, u8* visible) const;
+
+        inline u32 get_padded_count() const { return (u32)center_x.size(); }
+
+        std::vector<f32> center_x, center_y, center_z;
+        std::vector<f32> extents_x, extents_y, extents_z;
+        std::vector<f32> sphere_x, sphere_y, sphere_z, sphere_radius;
+    };
+}
@@ -0,0 +1,193 @@
+#include "light_clusters.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "link/job_system.hpp"
+
+namespace link
+{
+    void LightClusters::create()
+    {
+        index_count = 0;
+        params_ubo.create(sizeof(Params), BindingPoint::CLUSTERS);
+        cells_buffer.create(GL_RG32UI);
+        indices_buffer.create(GL_R32UI);
+        cells.resize(CLUSTER_COUNT);
+        cursors.resize(CLUSTER_COUNT);
+    }
+
+    f32 LightClusters::get_range(const LightSource& light)
+    {
+        if (light.type == LightSourceType::Directional)
+        {
+            return std::numeric_limits<f32>::infinity();
+        }
+
+        // solves constant + linear * d + quadratic * d^2 = 256 * brightest channel
+        const f32 brightest = std::max(light.color.r, std::max(light.color.g, light.color.b));
+        const f32 target = brightest * 256.0f - light.constant;
+        if (target <= 0.0f)
+        {
+            return 0.0f;
+        }
+        if (light.quadratic > 0.0f)
+        {
+            return (-light.linear + std::sqrt(light.linear * light.linear + 4.0f * light.quadratic * target)) / (2.0f * light.quadratic);
+        }
+        if (light.linear > 0.0f)
+        {
+            return target / light.linear;
+        }
+        return std::numeric_limits<f32>::infinity();
+    }
+
+    void LightClusters::compute_bounds(const LightSource& light, Bounds& bounds, const glm::mat4& view, const glm::mat4& projection, f32 near_plane, f32 far_plane, f32 scale, f32 bias) const
+    {
+        bounds.visible = false;
+
+        const f32 range = get_range(light);
+        const glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        const f32 depth = -center.z;
+        if (range <= 0.0f || depth + range < near_plane || depth - range > far_plane)
+        {
+            return;
+        }
+
+        auto slice = [scale, bias](f32 d) { return (u32)std::min(std::max(std::log(d) * scale - bias, 0.0f), (f32)(GRID_Z - 1)); };
+        bounds.min_z = slice(std::max(depth - range, near_plane));
+        bounds.max_z = slice(std::min(depth + range, far_plane));
+
+        // crossing the near plane, the projection of the box is unbounded
+        if (depth - range <= near_plane)
+        {
+            bounds.min_x = 0;
+            bounds.max_x = GRID_X - 1;
+            bounds.min_y = 0;
+            bounds.max_y = GRID_Y - 1;
+            bounds.visible = true;
+            return;
+        }
+
+        glm::vec2 min_ndc(std::numeric_limits<f32>::max());
+        glm::vec2 max_ndc(-std::numeric_limits<f32>::max());
+        for (u32 corner = 0; corner < 8; ++corner)
+        {
+            const glm::vec3 offset((corner & 1) ? range : -range, (corner & 2) ? range : -range, (corner & 4) ? range : -range);
+            const glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+            const glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            min_ndc = glm::min(min_ndc, ndc);
+            max_ndc = glm::max(max_ndc, ndc);
+        }
+        if (max_ndc.x < -1.0f || min_ndc.x > 1.0f || max_ndc.y < -1.0f || min_ndc.y > 1.0f)
+        {
+            return;
+        }
+
+        auto tile = [](f32 ndc, u32 count) { return (u32)std::min(std::max((ndc * 0.5f + 0.5f) * count, 0.0f), (f32)(count - 1)); };
+        bounds.min_x = tile(min_ndc.x, GRID_X);
+        bounds.max_x = tile(max_ndc.x, GRID_X);
+        bounds.min_y = tile(min_ndc.y, GRID_Y);
+        bounds.max_y = tile(max_ndc.y, GRID_Y);
+        bounds.visible = true;
+    }
+
+    void LightClusters::build(const LightSource* lights, u32 count, const glm::mat4& view, const glm::mat4& projection, f32 near_plane, f32 far_plane, const glm::vec2& screen_size)
+    {
+        const f32 log_depth = std::log(far_plane / near_plane);
+        const f32 scale = GRID_Z / log_depth;
+        const f32 bias = GRID_Z * std::log(near_plane) / log_depth;
+
+        // directional lights reach every cluster, they lead the index list instead of being repeated
+        light_indices.clear();
+        for (u32 i = 0; i < count; ++i)
+        {
+            const LightSource& light = lights[i];
+            if (light.type == LightSourceType::Directional && light.color != glm::vec3(0.0f))
+            {
+                light_indices.push_back(i);
+            }
+        }
+        const u32 directional_count = (u32)light_indices.size();
+
+        // clusters covered by the range of each light
+        light_bounds.resize(count);
+        LINK_JOBS->parallel_for(count, 64, [&](u32 begin, u32 end)
+        {
+            for (u32 i = begin; i < end; ++i)
+            {
+                if (lights[i].type == LightSourceType::Directional)
+                {
+                    light_bounds[i].visible = false;
+                    continue;
+                }
+                compute_bounds(lights[i], light_bounds[i], view, projection, near_plane, far_plane, scale, bias);
+            }
+        });
+
+        // every depth slice owns its clusters, slices are counted and filled in parallel
+        const u32 slice_size = GRID_X * GRID_Y;
+        auto for_each_cluster = [this, count, slice_size](u32 z, auto&& function)
+        {
+            for (u32 i = 0; i < count; ++i)
+            {
+                const Bounds& bounds = light_bounds[i];
+                if (!bounds.visible || z < bounds.min_z || z > bounds.max_z)
+                {
+                    continue;
+                }
+                for (u32 y = bounds.min_y; y <= bounds.max_y; ++y)
+                {
+                    for (u32 x = bounds.min_x; x <= bounds.max_x; ++x)
+                    {
+                        function(z * slice_size + y * GRID_X + x, i);
+                    }
+                }
+            }
+        };
+
+        LINK_JOBS->parallel_for(GRID_Z, 1, [&](u32 begin, u32 end)
+        {
+            for (u32 z = begin; z < end; ++z)
+            {
+                std::fill(cells.begin() + z * slice_size, cells.begin() + (z + 1) * slice_size, glm::uvec2(0));
+                for_each_cluster(z, [this](u32 cluster, u32) { cells[cluster].y++; });
+            }
+        });
+
+        u32 offset = directional_count;
+        for (u32 cluster = 0; cluster < CLUSTER_COUNT; ++cluster)
+        {
+            cells[cluster].x = offset;
+            cursors[cluster] = offset;
+            offset += cells[cluster].y;
+        }
+        light_indices.resize(offset);
+        index_count = offset;
+
+        LINK_JOBS->parallel_for(GRID_Z, 1, [&](u32 begin, u32 end)
+        {
+            for (u32 z = begin; z < end; ++z)
+            {
+                for_each_cluster(z, [this](u32 cluster, u32 light) { light_indices[cursors[cluster]++] = light; });
+            }
+        });
+
+        const Params params
+        {
+            glm::uvec4(GRID_X, GRID_Y, GRID_Z, directional_count),
+            glm::vec4(near_plane, far_plane, scale, bias),
+            glm::vec4(screen_size, 0.0f, 0.0f)
+        };
+        params_ubo.set_data(0, sizeof(Params), &params);
+        cells_buffer.upload(cells.data(), cells.size() * sizeof(glm::uvec2));
+        indices_buffer.upload(light_indices.data(), light_indices.size() * sizeof(u32));
+    }
+
+    void LightClusters::bind() const
+    {
+        cells_buffer.bind(GL_TEXTURE0 + CELLS_UNIT);
+        indices_buffer.bind(GL_TEXTURE0 + INDICES_UNIT);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "link/types.hpp"
+#include "ubo.hpp"
+#include "texture_buffer.hpp"
+#include "light_sources.hpp"
+
+namespace link
+{
+    // Clustered forward lighting : the view frustum is cut in GRID_X * GRID_Y screen tiles and GRID_Z
+    // depth slices (logarithmic), each cluster lists the lights whose range reaches it.
+    // Fragments only loop over the lights of their cluster, plus the directional lights that reach everything.
+    struct LightClusters
+    {
+        static constexpr u32 GRID_X = 16;
+        static constexpr u32 GRID_Y = 9;
+        static constexpr u32 GRID_Z = 24;
+        static constexpr u32 CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+        // texture units the shaders read the light data from, after the material textures
+        static constexpr int LIGHTS_UNIT = 5;
+        static constexpr int CELLS_UNIT = 6;
+        static constexpr int INDICES_UNIT = 7;
+
+        void create();
+        // bins lights[0, count) in the clusters of the camera, in parallel, and uploads the lists
+        void build(const LightSource* lights, u32 count, const glm::mat4& view, const glm::mat4& projection, f32 near_plane, f32 far_plane, const glm::vec2& screen_size);
+        void bind() const;
+
+        // distance past which the light adds less than 1/256 to a channel, infinite without attenuation
+        static f32 get_range(const LightSource& light);
+
+        u32 index_count;    // last build, directional lights included
+
+    private:
+        // clusters touched by one light, inclusive
+        struct Bounds
+        {
+            u32 min_x, max_x;
+            u32 min_y, max_y;
+            u32 min_z, max_z;
+            bool visible;
+        };
+
+        struct Params
+        {
+            glm::uvec4 grid;    // x, y, z, directional count
+            glm::vec4 depth;    // near, far, slice scale, slice bias
+            glm::vec4 screen;   // width, height
+        };
+
+        void compute_bounds(const LightSource& light, Bounds& bounds, const glm::mat4& view, const glm::mat4& projection, f32 near_plane, f32 far_plane, f32 scale, f32 bias) const;
+
+        UBO params_ubo;
+        TextureBuffer cells_buffer;     // offset, count in light_indices per cluster
+        TextureBuffer indices_buffer;
+
+        std::vector<Bounds> light_bounds;
+        std::vector<glm::uvec2> cells;
+        std::vector<u32> cursors;
+        std::vector<u32> light_indices;
+    };
+}
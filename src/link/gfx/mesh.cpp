@@ -1,18 +1,42 @@
 #include "mesh.hpp"
+#include "render_queue.hpp"
+#include "mesh_arena.hpp"
+#include "ring_buffer.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 
 #include <fmt/ostream.h>
+#include <cmath>
+#include <algorithm>
+#include <assert.h>
 
 
 namespace link
 {
-    Mesh::Mesh(const std::vector<Vertex>& v, const std::vector<u32>& i, GLenum mode)
+    Mesh::Mesh(const std::vector<Vertex>& v, const std::vector<u32>& i, GLenum mode, Storage s)
         : vertices(v)
         , indices(i)
         , mode(mode)
+        , storage(s)
+        , base_vertex(0)
+        , first_index(0)
     {
+        compute_bounds();
+
+        // nothing to suballocate, an empty mesh keeps its own (empty) buffers
+        if (storage == Storage::Arena && (vertices.empty() || indices.empty()))
+        {
+            storage = Storage::Own;
+        }
+        if (storage == Storage::Arena)
+        {
+            VBO = 0;
+            EBO = 0;
+            LINK_MESH_ARENA->allocate(*this);
+            return;
+        }
+
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
@@ -40,8 +64,38 @@ namespace link
         glBindVertexArray(0);
     }
 
+    void Mesh::compute_bounds()
+    {
+        if (vertices.empty())
+        {
+            bounds = { glm::vec3(0.0f), glm::vec3(0.0f) };
+            sphere = { glm::vec3(0.0f), 0.0f };
+            return;
+        }
+
+        bounds = { vertices[0].Position, vertices[0].Position };
+        for (const Vertex& vertex : vertices)
+        {
+            bounds.min = glm::min(bounds.min, vertex.Position);
+            bounds.max = glm::max(bounds.max, vertex.Position);
+        }
+
+        // tighter than the sphere around the box
+        sphere.center = bounds.center();
+        f32 radius_squared = 0.0f;
+        for (const Vertex& vertex : vertices)
+        {
+            const glm::vec3 d = vertex.Position - sphere.center;
+            radius_squared = std::max(radius_squared, glm::dot(d, d));
+        }
+        sphere.radius = std::sqrt(radius_squared);
+    }
+
     void Mesh::data_updated()
     {
+        assert(storage == Storage::Own);
+        compute_bounds();
+
         if (!indices.empty())
         {
             glBindVertexArray(VAO);
@@ -83,10 +137,15 @@ namespace link
         : vertices(v)
         , mode(m)
         , EBO(0)
+        , storage(Storage::Own)
+        , base_vertex(0)
+        , first_index(0)
     {
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
 
+        compute_bounds();
+
         glBindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
@@ -101,21 +160,59 @@ namespace link
 
     Mesh::~Mesh()
     {
+        if (storage == Storage::Arena)
+        {
+            LINK_MESH_ARENA->release(*this);
+            return;
+        }
         glDeleteVertexArrays(1, &VAO);
     }
 
 
     void Mesh::draw()
+    {
+        bind();
+        submit();
+    }
+
+    void Mesh::bind() const
     {
         glBindVertexArray(VAO);
+    }
+
+    void Mesh::submit(u32 instance_count, u32 first_instance) const
+    {
         if (indices.empty())
         {
-            glDrawArrays(mode, 0, vertices.size());
+            glDrawArraysInstancedBaseInstance(mode, 0, vertices.size(), instance_count, first_instance);
         }
         else
         {
-            glDrawElements(mode, indices.size(), GL_UNSIGNED_INT, 0);
+            glDrawElementsInstancedBaseVertexBaseInstance(mode, indices.size(), GL_UNSIGNED_INT, (void*)((size_t)first_index * sizeof(u32)), instance_count, base_vertex, first_instance);
         }
+    }
+
+    void Mesh::attach_instance_buffer(const RingBuffer& ring)
+    {
         glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, ring.id);
+
+        // matrix attributes take one location per column
+        for (u32 column = 0; column < 4; ++column)
+        {
+            const u32 location = INSTANCE_ATTRIBUTE + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+        }
+        for (u32 column = 0; column < 3; ++column)
+        {
+            const u32 location = INSTANCE_ATTRIBUTE + 4 + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offsetof(InstanceData, normal_matrix) + column * sizeof(glm::vec3)));
+            glVertexAttribDivisor(location, 1);
+        }
+
+        instance_generation = ring.generation;
     }
 }
\ No newline at end of file
@@ -11,9 +11,12 @@
 #include <string>
 
 #include "link/types.hpp"
+#include "link/physics/shapes.hpp"
 
 namespace link
 {
+    struct RingBuffer;
+
     struct Vertex
     {
         Vertex() {}
@@ -27,18 +30,40 @@ namespace link
 
     struct Mesh
     {
+        enum class Storage
+        {
+            Own,        // vertex array and buffers of its own, data_updated can replace the data
+            Arena,      // immutable, suballocated from the MeshArena, drawable with multi draw indirect
+        };
+
         u32 VAO, VBO, EBO;
         GLenum mode;
+        Storage storage;
+        u32 base_vertex;    // Storage::Arena : offsets in the arena buffers
+        u32 first_index;
 
         std::vector<Vertex> vertices;
         std::vector<u32> indices;
+        AABB bounds;
+        Sphere sphere;      // around the center of bounds, through the furthest vertex
 
-        Mesh(const std::vector<Vertex>& vertices, const std::vector<u32>& indices, GLenum mode = GL_TRIANGLES);
+        Mesh(const std::vector<Vertex>& vertices, const std::vector<u32>& indices, GLenum mode = GL_TRIANGLES, Storage storage = Storage::Own);
         Mesh(const std::vector<Vertex>& vertices, GLenum mode = GL_TRIANGLES);
 
         void data_updated();
+        void compute_bounds();
 
         ~Mesh();
         void draw();
+        // draw() in two halves, so draws of the same mesh only bind the vertex array once
+        void bind() const;
+        void submit(u32 instance_count = 1, u32 first_instance = 0) const;
+        inline bool is_shared() const { return storage == Storage::Arena; }
+        // per instance InstanceData : model matrix at attribute locations 3 to 6, normal matrix at 7 to 9,
+        // read from the ring from first_instance on
+        void attach_instance_buffer(const RingBuffer& ring);
+
+        static constexpr u32 INSTANCE_ATTRIBUTE = 3;
+        u32 instance_generation = 0;    // RingBuffer::generation attached, 0 for none
     };
 }
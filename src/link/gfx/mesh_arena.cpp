@@ -0,0 +1,148 @@
+#include "mesh_arena.hpp"
+
+#include <algorithm>
+
+#include "mesh.hpp"
+
+namespace link
+{
+    u32 RangeAllocator::allocate(u32 count)
+    {
+        for (u32 i = 0; i < free_ranges.size(); ++i)
+        {
+            Range& range = free_ranges[i];
+            if (range.count < count)
+            {
+                continue;
+            }
+
+            const u32 first = range.first;
+            range.first += count;
+            range.count -= count;
+            if (range.count == 0)
+            {
+                free_ranges.erase(free_ranges.begin() + i);
+            }
+            return first;
+        }
+        return U32_INVALID;
+    }
+
+    void RangeAllocator::release(u32 first, u32 count)
+    {
+        auto next = std::lower_bound(free_ranges.begin(), free_ranges.end(), first, [](const Range& range, u32 value) { return range.first < value; });
+        next = free_ranges.insert(next, { first, count });
+
+        // merge with the following range, then with the previous one
+        if (next + 1 != free_ranges.end() && next->first + next->count == (next + 1)->first)
+        {
+            next->count += (next + 1)->count;
+            free_ranges.erase(next + 1);
+        }
+        if (next != free_ranges.begin() && (next - 1)->first + (next - 1)->count == next->first)
+        {
+            (next - 1)->count += next->count;
+            free_ranges.erase(next);
+        }
+    }
+
+    void RangeAllocator::grow(u32 new_capacity)
+    {
+        const u32 old_capacity = capacity;
+        capacity = new_capacity;
+        release(old_capacity, new_capacity - old_capacity);
+    }
+
+    MeshArena::MeshArena()
+        : VAO(0)
+        , vertex_buffer(0)
+        , index_buffer(0)
+    {
+        // 1M vertices, 4M indices to start with : 32MB and 16MB
+        constexpr u32 VERTEX_CAPACITY = 1 << 20;
+        constexpr u32 INDEX_CAPACITY = 1 << 22;
+
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+
+        glGenBuffers(1, &vertex_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)VERTEX_CAPACITY * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+
+        glGenBuffers(1, &index_buffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)INDEX_CAPACITY * sizeof(u32), nullptr, GL_STATIC_DRAW);
+
+        bind_layout();
+        glBindVertexArray(0);
+
+        vertices.grow(VERTEX_CAPACITY);
+        indices.grow(INDEX_CAPACITY);
+    }
+
+    void MeshArena::bind_layout()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+
+        // same layout as the meshes owning their buffers
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    }
+
+    GLuint MeshArena::grow(GLuint buffer, u32 old_size, u32 new_size)
+    {
+        GLuint grown = 0;
+        glGenBuffers(1, &grown);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+        glBufferData(GL_COPY_WRITE_BUFFER, new_size, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_size);
+        glDeleteBuffers(1, &buffer);
+        return grown;
+    }
+
+    void MeshArena::allocate(Mesh& mesh)
+    {
+        const u32 vertex_count = (u32)mesh.vertices.size();
+        const u32 index_count = (u32)mesh.indices.size();
+
+        u32 base_vertex = vertices.allocate(vertex_count);
+        u32 first_index = indices.allocate(index_count);
+
+        glBindVertexArray(VAO);
+        if (base_vertex == U32_INVALID)
+        {
+            const u32 capacity = std::max(vertices.capacity * 2, vertices.capacity + vertex_count);
+            vertex_buffer = grow(vertex_buffer, vertices.capacity * sizeof(Vertex), capacity * sizeof(Vertex));
+            vertices.grow(capacity);
+            base_vertex = vertices.allocate(vertex_count);
+        }
+        if (first_index == U32_INVALID)
+        {
+            const u32 capacity = std::max(indices.capacity * 2, indices.capacity + index_count);
+            index_buffer = grow(index_buffer, indices.capacity * sizeof(u32), capacity * sizeof(u32));
+            indices.grow(capacity);
+            first_index = indices.allocate(index_count);
+        }
+        bind_layout();
+
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)base_vertex * sizeof(Vertex), vertex_count * sizeof(Vertex), mesh.vertices.data());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)first_index * sizeof(u32), index_count * sizeof(u32), mesh.indices.data());
+        glBindVertexArray(0);
+
+        mesh.VAO = VAO;
+        mesh.base_vertex = base_vertex;
+        mesh.first_index = first_index;
+    }
+
+    void MeshArena::release(Mesh& mesh)
+    {
+        vertices.release(mesh.base_vertex, (u32)mesh.vertices.size());
+        indices.release(mesh.first_index, (u32)mesh.indices.size());
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+#include <gl/GL.h>
+
+#include "link/types.hpp"
+#include "link/singleton.hpp"
+
+namespace link
+{
+    struct Mesh;
+
+    // First fit allocator over [0, capacity), freed ranges are merged with their neighbours.
+    struct RangeAllocator
+    {
+        struct Range
+        {
+            u32 first;
+            u32 count;
+        };
+
+        // U32_INVALID when no free range is large enough
+        u32 allocate(u32 count);
+        void release(u32 first, u32 count);
+        // the new space goes at the end, merged with a trailing free range
+        void grow(u32 new_capacity);
+
+        std::vector<Range> free_ranges;     // sorted on first
+        u32 capacity = 0;
+    };
+
+    // Static meshes share one vertex buffer, one index buffer and one vertex array (layout of Vertex),
+    // so draws of different meshes need no vertex array change and can go in a single multi draw indirect.
+    // Meshes keep their first index and base vertex; the buffers grow by copy when they run out of room.
+    struct MeshArena : Singleton<MeshArena>
+    {
+        MeshArena();
+
+        // uploads the vertices and indices of mesh, sets its VAO, first_index and base_vertex
+        void allocate(Mesh& mesh);
+        void release(Mesh& mesh);
+
+        GLuint VAO;
+        GLuint vertex_buffer;
+        GLuint index_buffer;
+        RangeAllocator vertices;
+        RangeAllocator indices;
+
+    private:
+        // copies the old content over and points the vertex array at the new buffers
+        GLuint grow(GLuint buffer, u32 old_size, u32 new_size);
+        void bind_layout();
+    };
+}
+
+#define LINK_MESH_ARENA link::MeshArena::get()
@@ -0,0 +1,319 @@
+#include "occlusion.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include "link/job_system.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define LINK_OCCLUSION_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace link
+{
+    OcclusionBuffer::OcclusionBuffer()
+        : view_projection(1.0f)
+        , near_plane(0.1f)
+        , depth(WIDTH * HEIGHT, 0.0f)
+    {
+    }
+
+    void OcclusionBuffer::begin(const glm::mat4& view_projection, f32 near_plane)
+    {
+        this->view_projection = view_projection;
+        this->near_plane = near_plane;
+        polygons.clear();
+        std::fill(depth.begin(), depth.end(), 0.0f);
+    }
+
+    void OcclusionBuffer::add_triangles(const glm::vec3* positions, u32 stride, const u32* indices, u32 index_count, const glm::mat4& model)
+    {
+        const glm::mat4 matrix = view_projection * model;
+        const u8* base = (const u8*)positions;
+
+        for (u32 i = 0; i + 2 < index_count; i += 3)
+        {
+            const glm::vec4 clip[3] =
+            {
+                matrix * glm::vec4(*(const glm::vec3*)(base + indices[i + 0] * stride), 1.0f),
+                matrix * glm::vec4(*(const glm::vec3*)(base + indices[i + 1] * stride), 1.0f),
+                matrix * glm::vec4(*(const glm::vec3*)(base + indices[i + 2] * stride), 1.0f),
+            };
+            add_polygon(clip, 3);
+        }
+    }
+
+    void OcclusionBuffer::add_box(const AABB& box, const glm::mat4& model)
+    {
+        const glm::mat4 matrix = view_projection * model;
+        glm::vec4 corners[8];
+        for (u32 i = 0; i < 8; ++i)
+        {
+            corners[i] = matrix * glm::vec4((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z, 1.0f);
+        }
+
+        // corners in order around each face, one quad each so no diagonal is left empty
+        static const u32 faces[6][4] =
+        {
+            { 0, 2, 3, 1 },   // -z
+            { 4, 5, 7, 6 },   // +z
+            { 0, 4, 6, 2 },   // -x
+            { 1, 3, 7, 5 },   // +x
+            { 0, 1, 5, 4 },   // -y
+            { 2, 6, 7, 3 },   // +y
+        };
+        for (const u32* face : faces)
+        {
+            const glm::vec4 clip[4] = { corners[face[0]], corners[face[1]], corners[face[2]], corners[face[3]] };
+            add_polygon(clip, 4);
+        }
+    }
+
+    void OcclusionBuffer::add_polygon(const glm::vec4* clip, u32 count)
+    {
+        glm::vec3 v[4];
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (clip[i].w < near_plane)
+            {
+                return;
+            }
+
+            const f32 inv_w = 1.0f / clip[i].w;
+            v[i] = { (clip[i].x * inv_w * 0.5f + 0.5f) * WIDTH, (clip[i].y * inv_w * 0.5f + 0.5f) * HEIGHT, inv_w };
+        }
+
+        // twice the signed area
+        f32 area = 0.0f;
+        for (u32 i = 0; i < count; ++i)
+        {
+            const glm::vec3& from = v[i];
+            const glm::vec3& to = v[(i + 1) % count];
+            area += from.x * to.y - to.x * from.y;
+        }
+        if (std::abs(area) < 1e-6f)
+        {
+            return;
+        }
+
+        // both faces are drawn, clockwise polygons are reversed so the edge functions are positive inside
+        if (area < 0.0f)
+        {
+            std::reverse(v, v + count);
+        }
+
+        // nothing left once outside the screen
+        f32 min_x = v[0].x, max_x = v[0].x;
+        f32 min_y = v[0].y, max_y = v[0].y;
+        for (u32 i = 1; i < count; ++i)
+        {
+            min_x = std::min(min_x, v[i].x);
+            max_x = std::max(max_x, v[i].x);
+            min_y = std::min(min_y, v[i].y);
+            max_y = std::max(max_y, v[i].y);
+        }
+        if (max_x < 0.0f || max_y < 0.0f || min_x > (f32)WIDTH || min_y > (f32)HEIGHT)
+        {
+            return;
+        }
+
+        Polygon polygon;
+
+        // pixels whose center may be inside, x from a multiple of 4
+        polygon.min_x = std::max((i32)std::floor(min_x), 0) & ~3;
+        polygon.max_x = std::min((i32)std::ceil(max_x), (i32)WIDTH - 1);
+        polygon.min_y = std::max((i32)std::floor(min_y), 0);
+        polygon.max_y = std::min((i32)std::ceil(max_y), (i32)HEIGHT - 1);
+
+        // edge i goes from v[i] to v[i + 1], moved inwards by half a pixel : positive at a pixel center
+        // means the whole pixel is inside
+        for (u32 i = 0; i < 4; ++i)
+        {
+            if (i < count)
+            {
+                const glm::vec3& from = v[i];
+                const glm::vec3& to = v[(i + 1) % count];
+                polygon.a[i] = from.y - to.y;
+                polygon.b[i] = to.x - from.x;
+                polygon.c[i] = -(polygon.a[i] * from.x + polygon.b[i] * from.y) - 0.5f * (std::abs(polygon.a[i]) + std::abs(polygon.b[i]));
+            }
+            else
+            {
+                polygon.a[i] = 0.0f;
+                polygon.b[i] = 0.0f;
+                polygon.c[i] = 1.0f;
+            }
+        }
+
+        // 1/w is a plane in screen space, taken from the larger half of a quad
+        u32 i1 = 1, i2 = 2;
+        if (count == 4
+            && (v[2].x - v[0].x) * (v[3].y - v[0].y) - (v[2].y - v[0].y) * (v[3].x - v[0].x)
+               > (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x))
+        {
+            i1 = 2;
+            i2 = 3;
+        }
+        const glm::vec3& v0 = v[0];
+        const glm::vec3& v1 = v[i1];
+        const glm::vec3& v2 = v[i2];
+        const f32 plane_area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        polygon.dz_dx = ((v1.z - v0.z) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.z - v0.z)) / plane_area;
+        polygon.dz_dy = ((v1.x - v0.x) * (v2.z - v0.z) - (v1.z - v0.z) * (v2.x - v0.x)) / plane_area;
+
+        // farthest 1/w over the pixel rather than at its center
+        polygon.z_c = v0.z - polygon.dz_dx * v0.x - polygon.dz_dy * v0.y - 0.5f * (std::abs(polygon.dz_dx) + std::abs(polygon.dz_dy));
+
+        polygons.push_back(polygon);
+    }
+
+    void OcclusionBuffer::rasterize()
+    {
+        // bands own their rows, no two jobs write the same pixel
+        LINK_JOBS->parallel_for(HEIGHT / BAND_HEIGHT, 1, [this](u32 begin, u32 end)
+        {
+            for (u32 band = begin; band < end; ++band)
+            {
+                rasterize_band(band * BAND_HEIGHT, (band + 1) * BAND_HEIGHT);
+            }
+        });
+    }
+
+    void OcclusionBuffer::rasterize_band(u32 first_row, u32 end_row)
+    {
+        for (const Polygon& polygon : polygons)
+        {
+            const i32 min_x = polygon.min_x;
+            const i32 max_x = polygon.max_x;
+            const i32 min_y = std::max(polygon.min_y, (i32)first_row);
+            const i32 max_y = std::min(polygon.max_y, (i32)end_row - 1);
+            if (min_x > max_x || min_y > max_y)
+            {
+                continue;
+            }
+
+            const f32* a = polygon.a;
+            const f32* b = polygon.b;
+            const f32* c = polygon.c;
+            const f32 dz_dx = polygon.dz_dx;
+            const f32 dz_dy = polygon.dz_dy;
+            const f32 z_c = polygon.z_c;
+
+            const f32 start_x = (f32)min_x + 0.5f;
+            for (i32 y = min_y; y <= max_y; ++y)
+            {
+                const f32 center_y = (f32)y + 0.5f;
+                f32* row = &depth[y * WIDTH];
+
+#ifdef LINK_OCCLUSION_SSE
+                const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+                __m128 e0 = _mm_add_ps(_mm_set1_ps(a[0] * start_x + b[0] * center_y + c[0]), _mm_mul_ps(lanes, _mm_set1_ps(a[0])));
+                __m128 e1 = _mm_add_ps(_mm_set1_ps(a[1] * start_x + b[1] * center_y + c[1]), _mm_mul_ps(lanes, _mm_set1_ps(a[1])));
+                __m128 e2 = _mm_add_ps(_mm_set1_ps(a[2] * start_x + b[2] * center_y + c[2]), _mm_mul_ps(lanes, _mm_set1_ps(a[2])));
+                __m128 e3 = _mm_add_ps(_mm_set1_ps(a[3] * start_x + b[3] * center_y + c[3]), _mm_mul_ps(lanes, _mm_set1_ps(a[3])));
+                __m128 z = _mm_add_ps(_mm_set1_ps(dz_dx * start_x + dz_dy * center_y + z_c), _mm_mul_ps(lanes, _mm_set1_ps(dz_dx)));
+                const __m128 step_e0 = _mm_set1_ps(a[0] * 4.0f);
+                const __m128 step_e1 = _mm_set1_ps(a[1] * 4.0f);
+                const __m128 step_e2 = _mm_set1_ps(a[2] * 4.0f);
+                const __m128 step_e3 = _mm_set1_ps(a[3] * 4.0f);
+                const __m128 step_z = _mm_set1_ps(dz_dx * 4.0f);
+                const __m128 zero = _mm_setzero_ps();
+
+                for (i32 x = min_x; x <= max_x; x += 4)
+                {
+                    const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                                                     _mm_and_ps(_mm_cmpge_ps(e2, zero), _mm_cmpge_ps(e3, zero)));
+                    if (_mm_movemask_ps(inside))
+                    {
+                        const __m128 current = _mm_loadu_ps(row + x);
+                        const __m128 nearest = _mm_max_ps(current, z);
+                        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+                    }
+
+                    e0 = _mm_add_ps(e0, step_e0);
+                    e1 = _mm_add_ps(e1, step_e1);
+                    e2 = _mm_add_ps(e2, step_e2);
+                    e3 = _mm_add_ps(e3, step_e3);
+                    z = _mm_add_ps(z, step_z);
+                }
+#else
+                for (i32 x = min_x; x <= max_x; ++x)
+                {
+                    const f32 center_x = (f32)x + 0.5f;
+                    if (a[0] * center_x + b[0] * center_y + c[0] >= 0.0f
+                        && a[1] * center_x + b[1] * center_y + c[1] >= 0.0f
+                        && a[2] * center_x + b[2] * center_y + c[2] >= 0.0f
+                        && a[3] * center_x + b[3] * center_y + c[3] >= 0.0f)
+                    {
+                        row[x] = std::max(row[x], dz_dx * center_x + dz_dy * center_y + z_c);
+                    }
+                }
+#endif
+            }
+        }
+    }
+
+    bool OcclusionBuffer::is_visible(const AABB& box) const
+    {
+        f32 min_x = 1e30f, max_x = -1e30f;
+        f32 min_y = 1e30f, max_y = -1e30f;
+        f32 nearest = 0.0f;
+        for (u32 i = 0; i < 8; ++i)
+        {
+            const glm::vec3 corner((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+            const glm::vec4 clip = view_projection * glm::vec4(corner, 1.0f);
+            if (clip.w < near_plane)
+            {
+                return true;
+            }
+
+            const f32 inv_w = 1.0f / clip.w;
+            const f32 x = (clip.x * inv_w * 0.5f + 0.5f) * WIDTH;
+            const f32 y = (clip.y * inv_w * 0.5f + 0.5f) * HEIGHT;
+            min_x = std::min(min_x, x);
+            max_x = std::max(max_x, x);
+            min_y = std::min(min_y, y);
+            max_y = std::max(max_y, y);
+            nearest = std::max(nearest, inv_w);
+        }
+
+        // every pixel the screen rectangle of the box touches
+        const i32 first_x = std::max((i32)std::floor(min_x), 0);
+        const i32 last_x = std::min((i32)std::ceil(max_x) - 1, (i32)WIDTH - 1);
+        const i32 first_y = std::max((i32)std::floor(min_y), 0);
+        const i32 last_y = std::min((i32)std::ceil(max_y) - 1, (i32)HEIGHT - 1);
+        if (first_x > last_x || first_y > last_y)
+        {
+            // off screen, left to the frustum test
+            return true;
+        }
+
+        for (i32 y = first_y; y <= last_y; ++y)
+        {
+            const f32* row = &depth[y * WIDTH];
+
+#ifdef LINK_OCCLUSION_SSE
+            const __m128 box_depth = _mm_set1_ps(nearest);
+            for (i32 x = first_x & ~3; x <= last_x; x += 4)
+            {
+                // lanes outside [first_x, last_x] are masked out
+                const i32 lane_mask = (0xF << std::max(first_x - x, 0)) & (0xF >> std::max(x + 3 - last_x, 0));
+                if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(row + x), box_depth)) & lane_mask)
+                {
+                    return true;
+                }
+            }
+#else
+            for (i32 x = first_x; x <= last_x; ++x)
+            {
+                if (row[x] <= nearest)
+                {
+                    return true;
+                }
+            }
+#endif
+        }
+        return false;
+    }
+}
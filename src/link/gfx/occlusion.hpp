@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "link/types.hpp"
+#include "link/physics/shapes.hpp"
+
+namespace link
+{
+    // Small cpu depth buffer for occlusion culling, no gl involved.
+    // Occluder polygons are rasterized in bands of rows on the job system, then boxes are tested
+    // against the result : a box is hidden when every pixel it touches holds an occluder nearer than
+    // the nearest corner of the box. Pixels store 1/w (linear in screen space, 0 = nothing drawn).
+    // Occluders only write the pixels they cover entirely, with their farthest depth over the pixel,
+    // so a box sticking out of them by less than a pixel still finds an empty one. Box faces are
+    // drawn as quads, mesh triangles leave their shared edges empty.
+    // Polygons crossing the near plane are dropped instead of clipped, boxes crossing it are visible,
+    // all these errors only ever keep something visible.
+    struct OcclusionBuffer
+    {
+        static constexpr u32 WIDTH = 256;   // multiple of 4, pixels are processed 4 at a time
+        static constexpr u32 HEIGHT = 128;
+        static constexpr u32 BAND_HEIGHT = 8;
+
+        OcclusionBuffer();
+
+        // clears the buffer and the triangles of the last frame
+        void begin(const glm::mat4& view_projection, f32 near_plane);
+
+        // positions are read stride bytes apart, triangles are not culled by their facing
+        void add_triangles(const glm::vec3* positions, u32 stride, const u32* indices, u32 index_count, const glm::mat4& model);
+        // the 6 faces of the box, once transformed by model
+        void add_box(const AABB& box, const glm::mat4& model);
+
+        // draws the polygons added since begin()
+        void rasterize();
+
+        // box in world space, thread safe once rasterize() returned
+        bool is_visible(const AABB& box) const;
+
+        inline u32 get_polygon_count() const { return (u32)polygons.size(); }
+        inline f32 get_depth(u32 x, u32 y) const { return depth[y * WIDTH + x]; }
+
+    private:
+        // convex, e = a * x + b * y + c is positive on the pixels fully inside edge i,
+        // triangles repeat a last edge that is always positive
+        struct Polygon
+        {
+            f32 a[4], b[4], c[4];
+            f32 dz_dx, dz_dy, z_c;
+            i32 min_x, max_x, min_y, max_y;
+        };
+
+        // clip space vertices of a convex polygon, 3 or 4 of them
+        void add_polygon(const glm::vec4* clip, u32 count);
+        void rasterize_band(u32 first_row, u32 end_row);
+
+        glm::mat4 view_projection;
+        f32 near_plane;
+        std::vector<Polygon> polygons;
+        std::vector<f32> depth;
+    };
+}
@@ -0,0 +1,142 @@
+#include "program_cache.hpp"
+
+#include <vector>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "render_queue.hpp"
+#include "link/data_root.hpp"
+#include "link/file.hpp"
+
+namespace link
+{
+    ProgramCache::ProgramCache()
+        : enabled(false)
+        , directory(std::string(LINK_DATA_ROOT) + "cache/shaders/")
+        , hits(0)
+        , misses(0)
+        , driver_hash(0)
+    {
+        GLint format_count = 0;
+        if (GLEW_ARB_get_program_binary)
+        {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+        }
+        enabled = format_count > 0;
+        if (!enabled)
+        {
+            return;
+        }
+
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+        {
+            const char* value = (const char*)glGetString(name);
+            driver_hash = hash_state(value, value ? std::strlen(value) : 0, driver_hash ^ name);
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+
+    u64 ProgramCache::make_key(std::initializer_list<std::string_view> sources) const
+    {
+        u64 key = hash_state(&driver_hash, sizeof(driver_hash));
+        for (std::string_view source : sources)
+        {
+            // the size goes in too, moving text from one stage to the next changes the key
+            const u64 size = source.size();
+            key = hash_state(&size, sizeof(size), key);
+            key = hash_state(source.data(), source.size(), key);
+        }
+        return key;
+    }
+
+    std::string ProgramCache::get_path(u64 key) const
+    {
+        return fmt::format("{}{:016x}.bin", directory, key);
+    }
+
+    bool ProgramCache::load(GLuint program, u64 key)
+    {
+        if (!enabled)
+        {
+            return false;
+        }
+
+        const std::string path = get_path(key);
+        u8* content = nullptr;
+        const i32 size = File::read(path, &content);
+        if (size < 0)
+        {
+            misses++;
+            return false;
+        }
+
+        Header header;
+        bool valid = size >= (i32)sizeof(Header);
+        if (valid)
+        {
+            std::memcpy(&header, content, sizeof(Header));
+            valid = header.magic == MAGIC && header.version == VERSION && header.key == key && header.size == size - sizeof(Header);
+        }
+
+        GLint linked = GL_FALSE;
+        if (valid)
+        {
+            glProgramBinary(program, header.format, content + sizeof(Header), header.size);
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        }
+        free(content);
+
+        if (!linked)
+        {
+            fmt::print("ProgramCache : dropping stale binary {}\n", path);
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            misses++;
+            return false;
+        }
+
+        hits++;
+        return true;
+    }
+
+    void ProgramCache::prepare(GLuint program) const
+    {
+        if (enabled)
+        {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+    }
+
+    void ProgramCache::store(GLuint program, u64 key)
+    {
+        if (!enabled)
+        {
+            return;
+        }
+
+        GLint linked = GL_FALSE;
+        GLint length = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (!linked || length <= 0)
+        {
+            return;
+        }
+
+        std::vector<u8> content(sizeof(Header) + length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, content.data() + sizeof(Header));
+
+        const Header header{ MAGIC, VERSION, key, format, (u32)length };
+        std::memcpy(content.data(), &header, sizeof(Header));
+
+        if (!File::write(get_path(key), content.data(), (u32)content.size()))
+        {
+            fmt::print("ProgramCache : cannot write {}\n", get_path(key));
+        }
+    }
+}
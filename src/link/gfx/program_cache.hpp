@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <initializer_list>
+#include <GL/glew.h>
+#include <gl/GL.h>
+
+#include "link/types.hpp"
+#include "link/singleton.hpp"
+
+namespace link
+{
+    // Linked programs saved to disk with glGetProgramBinary, one file per key.
+    // The key hashes every source fed to the compiler (defines included) and the driver strings,
+    // so editing a shader or updating the driver misses instead of loading a stale program.
+    // A binary the driver rejects anyway is dropped, the caller compiles and stores a fresh one.
+    struct ProgramCache : Singleton<ProgramCache>
+    {
+        ProgramCache();
+
+        u64 make_key(std::initializer_list<std::string_view> sources) const;
+        // true when program is linked from the cached binary
+        bool load(GLuint program, u64 key);
+        // call before linking a program that is going to be stored
+        void prepare(GLuint program) const;
+        // saves a linked program, ignored when the link failed
+        void store(GLuint program, u64 key);
+
+        bool enabled;       // the driver supports program binaries
+        std::string directory;
+        u32 hits;
+        u32 misses;
+
+    private:
+        struct Header
+        {
+            u32 magic;
+            u32 version;
+            u64 key;
+            u32 format;     // binary format given by the driver
+            u32 size;
+        };
+
+        static constexpr u32 MAGIC = 0x4350424C; // "LBPC"
+        static constexpr u32 VERSION = 1;
+
+        std::string get_path(u64 key) const;
+
+        u64 driver_hash;
+    };
+}
+
+#define LINK_PROGRAM_CACHE link::ProgramCache::get()
@@ -0,0 +1,97 @@
+#include "render_queue.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "shader.hpp"
+#include "mesh.hpp"
+#include "link/scene/components/c_material.hpp"
+
+namespace link
+{
+    u64 RenderQueue::make_key(Pass pass, const Shader* shader, u64 material_state, const Mesh* mesh, f32 depth)
+    {
+        depth = std::clamp(depth, 0.0f, 1.0f);
+        if (pass == Pass::Transparent)
+        {
+            depth = 1.0f - depth;
+        }
+
+        const u64 pass_bits = (u64)pass & 0x3;
+        const u64 shader_bits = (u64)shader->id & 0x3FFF;
+        const u64 material_bits = (material_state ^ (material_state >> 16) ^ (material_state >> 32) ^ (material_state >> 48)) & 0xFFFF;
+        // meshes of the same vertex array first (arena meshes all share one), then the mesh itself
+        const u64 mesh_bits = (((u64)mesh->VAO & 0xFF) << 8) | (hash_state(&mesh, sizeof(mesh)) & 0xFF);
+        const u64 depth_bits = (u64)(depth * 65535.0f);
+
+        return (pass_bits << 62) | (shader_bits << 48) | (material_bits << 32) | (mesh_bits << 16) | depth_bits;
+    }
+
+    bool RenderQueue::can_instance(const Packet& a, const Packet& b)
+    {
+        return a.mesh == b.mesh
+            && a.material_state == b.material_state
+            && (a.material == b.material || a.material->has_same_state(*b.material));
+    }
+
+    void RenderQueue::clear()
+    {
+        packets.clear();
+        order.clear();
+    }
+
+    void RenderQueue::sort()
+    {
+        const u32 count = (u32)packets.size();
+
+        items.resize(count);
+        scratch.resize(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            items[i] = { packets[i].key, i };
+        }
+
+        // every histogram in one read, 8 passes of 8 bits
+        u32 histograms[8][256];
+        std::memset(histograms, 0, sizeof(histograms));
+        for (const SortItem& item : items)
+        {
+            for (u32 pass = 0; pass < 8; ++pass)
+            {
+                histograms[pass][(item.key >> (pass * 8)) & 0xFF]++;
+            }
+        }
+
+        for (u32 pass = 0; pass < 8; ++pass)
+        {
+            u32* histogram = histograms[pass];
+            const u32 shift = pass * 8;
+
+            // every key has the same byte, the pass would not move anything
+            if (count == 0 || histogram[(items[0].key >> shift) & 0xFF] == count)
+            {
+                continue;
+            }
+
+            u32 offset = 0;
+            for (u32 bucket = 0; bucket < 256; ++bucket)
+            {
+                const u32 size = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += size;
+            }
+
+            for (const SortItem& item : items)
+            {
+                scratch[histogram[(item.key >> shift) & 0xFF]++] = item;
+            }
+            items.swap(scratch);
+        }
+
+        order.resize(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            order[i] = items[i].index;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "link/types.hpp"
+
+namespace link
+{
+    // FNV-1a, seed with the previous result to chain values
+    inline u64 hash_state(const void* data, size_t size, u64 seed = 14695981039346656037ull)
+    {
+        const u8* bytes = (const u8*)data;
+        for (size_t i = 0; i < size; ++i)
+        {
+            seed = (seed ^ bytes[i]) * 1099511628211ull;
+        }
+        return seed;
+    }
+
+    struct Shader;
+    struct CMaterial;
+    struct Mesh;
+
+    // per object constants, read as instanced vertex attributes (Mesh::attach_instance_buffer)
+    struct InstanceData
+    {
+        glm::mat4 model;
+        glm::mat3 normal_matrix;    // inverse transpose of the upper 3x3 of model, once per object instead of per vertex
+    };
+
+    // one draw of glMultiDrawElementsIndirect
+    struct DrawElementsCommand
+    {
+        u32 count;
+        u32 instance_count;
+        u32 first_index;
+        i32 base_vertex;
+        u32 base_instance;
+    };
+
+    // Draws of one frame, sorted on a packed 64 bits key :
+    //  63..62 pass | 61..48 shader | 47..32 material | 31..16 mesh | 15..0 depth
+    // Draws sharing a shader end up next to each other, then the ones with the same material values, then a mesh.
+    // The ids in the key are hashes, collisions only cost sorting quality : submission compares the actual
+    // pointers and the full material state before changing any state or merging draws into one instanced draw.
+    struct RenderQueue
+    {
+        enum class Pass : u8
+        {
+            Opaque = 0,         // front to back
+            Transparent = 1,    // back to front
+        };
+
+        struct Packet
+        {
+            u64 key;
+            u64 material_state;     // CMaterial::get_state_hash
+            CMaterial* material;
+            Mesh* mesh;
+            InstanceData instance;
+        };
+
+        // depth is the normalized view distance, in [0, 1]
+        static u64 make_key(Pass pass, const Shader* shader, u64 material_state, const Mesh* mesh, f32 depth);
+        // same mesh, same shader and same material values : both draws can be one instanced draw
+        static bool can_instance(const Packet& a, const Packet& b);
+
+        void clear();
+        // LSD radix sort of the keys, fills order
+        void sort();
+
+        std::vector<Packet> packets;
+        std::vector<u32> order;     // indices in packets, by increasing key
+
+    private:
+        struct SortItem
+        {
+            u64 key;
+            u32 index;
+        };
+
+        std::vector<SortItem> items;
+        std::vector<SortItem> scratch;
+    };
+}
@@ -0,0 +1,142 @@
+#include "ring_buffer.hpp"
+
+#include <algorithm>
+
+namespace link
+{
+    RingBuffer::RingBuffer()
+        : id(0)
+        , generation(0)
+        , target(GL_ARRAY_BUFFER)
+        , element_size(0)
+        , capacity(0)
+        , region(0)
+        , persistent(false)
+        , mapped(nullptr)
+        , fences {}
+    {
+    }
+
+    RingBuffer::~RingBuffer()
+    {
+        clear();
+    }
+
+    void RingBuffer::create(GLenum t, u32 size, u32 count)
+    {
+        target = t;
+        element_size = size;
+        persistent = GLEW_ARB_buffer_storage != GL_FALSE;
+        allocate(std::max(count, 1u));
+    }
+
+    void RingBuffer::allocate(u32 new_capacity)
+    {
+        for (u32 i = 0; i < REGION_COUNT; ++i)
+        {
+            wait(i);
+        }
+
+        // names are recycled once deleted, users compare generations to know they have to rebind
+        GLuint old_id = id;
+        glGenBuffers(1, &id);
+        if (old_id)
+        {
+            glBindBuffer(target, old_id);
+            if (persistent)
+            {
+                glUnmapBuffer(target);
+            }
+            glDeleteBuffers(1, &old_id);
+        }
+
+        generation++;
+        capacity = new_capacity;
+        region = 0;
+        mapped = nullptr;
+
+        const GLsizeiptr size = (GLsizeiptr)REGION_COUNT * capacity * element_size;
+        glBindBuffer(target, id);
+        if (persistent)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(target, size, nullptr, flags);
+            mapped = (u8*)glMapBufferRange(target, 0, size, flags);
+        }
+        else
+        {
+            glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+        }
+    }
+
+    void RingBuffer::wait(u32 index)
+    {
+        if (!fences[index])
+        {
+            return;
+        }
+        // the region was submitted at least REGION_COUNT - 1 frames ago, this rarely blocks
+        while (glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+        {
+        }
+        glDeleteSync(fences[index]);
+        fences[index] = nullptr;
+    }
+
+    void* RingBuffer::begin(u32 count)
+    {
+        if (count > capacity)
+        {
+            allocate(std::max(count, capacity * 2));
+        }
+        wait(region);
+
+        const size_t offset = (size_t)region * capacity * element_size;
+        if (persistent)
+        {
+            return mapped + offset;
+        }
+
+        glBindBuffer(target, id);
+        return glMapBufferRange(target, offset, (size_t)count * element_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+
+    void RingBuffer::end()
+    {
+        if (!persistent)
+        {
+            glBindBuffer(target, id);
+            glUnmapBuffer(target);
+        }
+    }
+
+    void RingBuffer::fence()
+    {
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        region = (region + 1) % REGION_COUNT;
+    }
+
+    void RingBuffer::clear()
+    {
+        for (u32 i = 0; i < REGION_COUNT; ++i)
+        {
+            if (fences[i])
+            {
+                glDeleteSync(fences[i]);
+                fences[i] = nullptr;
+            }
+        }
+        if (id)
+        {
+            if (persistent)
+            {
+                glBindBuffer(target, id);
+                glUnmapBuffer(target);
+            }
+            glDeleteBuffers(1, &id);
+        }
+        id = 0;
+        capacity = 0;
+        mapped = nullptr;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <gl/GL.h>
+
+#include "link/types.hpp"
+
+namespace link
+{
+    // Buffer cut in REGION_COUNT regions, one written per frame while the gpu still reads the previous ones.
+    // The storage stays mapped (ARB_buffer_storage), a fence per region keeps the cpu from overwriting data in flight.
+    // Without buffer storage each region is mapped unsynchronized for the frame instead, behind the same fences.
+    struct RingBuffer
+    {
+        static constexpr u32 REGION_COUNT = 3;
+
+        RingBuffer();
+        ~RingBuffer();
+
+        // capacity is the number of elements of element_size bytes per region
+        void create(GLenum target, u32 element_size, u32 capacity);
+        // region of this frame, room for at least count elements; grows the buffer (new name and generation) when needed
+        void* begin(u32 count);
+        // writes since begin are done, call before drawing from the region
+        void end();
+        // after the draws reading the region : fences it, the next begin moves on to the following one
+        void fence();
+        void clear();
+
+        // first element of the current region, base instance / offset of the elements written since begin
+        inline u32 get_first_element() const { return region * capacity; }
+
+        GLuint id;
+        u32 generation;     // bumped by every allocation, vertex arrays pointing at an older one have to be set up again
+        GLenum target;
+        u32 element_size;
+        u32 capacity;
+        u32 region;
+        bool persistent;
+        u8* mapped;
+
+    private:
+        void allocate(u32 new_capacity);
+        void wait(u32 index);
+
+        GLsync fences[REGION_COUNT];
+    };
+}
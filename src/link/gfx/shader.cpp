@@ -2,10 +2,16 @@
 
 
 #include <glm/gtc/type_ptr.hpp>
+#include <filesystem>
+#include <sstream>
+#include <algorithm>
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+#include "program_cache.hpp"
+#include "shader_compiler.hpp"
+
 //char* shader_src[3];
 //shader_src[0] = "#version ...\n";
 //shader_src[1] = ReadHeaderFile(....);
@@ -17,6 +23,7 @@ namespace link
 {
     Shader::Shader()
         : id(0)
+        , generation(0)
         , vertex_object(0)
         , fragment_object(0)
         , geometry_object(0)
@@ -26,15 +33,39 @@ namespace link
     Shader::~Shader()
     {
         unload();
+        LINK_SHADER_COMPILER->forget(this);
+    }
+
+    namespace
+    {
+        // a file being written may be missing for a moment, it is skipped until it is back
+        std::filesystem::file_time_type latest_write_time(const std::vector<std::string>& files)
+        {
+            std::filesystem::file_time_type latest = std::filesystem::file_time_type::min();
+            for (const std::string& file : files)
+            {
+                std::error_code error;
+                const std::filesystem::file_time_type time = std::filesystem::last_write_time(file, error);
+                if (!error && time > latest)
+                {
+                    latest = time;
+                }
+            }
+            return latest;
+        }
     }
 
-    bool Shader::load(const std::string& vertex_path, const std::string& fragment_path, const std::string& geometry_path)
+    bool Shader::load(const std::string& vertex_path, const std::string& fragment_path, const std::string& geometry_path, const std::string& defines)
     {
-        bool success = false;
+        return load_async(vertex_path, fragment_path, geometry_path, defines) && wait();
+    }
 
+    bool Shader::load_async(const std::string& vertex_path, const std::string& fragment_path, const std::string& geometry_path, const std::string& defines)
+    {
         this->vertex_path = vertex_path;
         this->fragment_path = fragment_path;
         this->geometry_path = geometry_path;
+        this->defines = defines;
 
         std::string vertex_code;
         std::string fragment_code;
@@ -67,46 +98,124 @@ namespace link
             File::read(geometry_path, geometry_code);
         }
 
-        if (vertex_code != "" && fragment_code != "")
+        // the program cache key is computed on the expanded sources, it covers includes and defines
+        files.clear();
+        vertex_code = preprocess(vertex_path, vertex_code, defines, &files);
+        fragment_code = preprocess(fragment_path, fragment_code, defines, &files);
+        geometry_code = preprocess(geometry_path, geometry_code, defines, &files);
+        files_time = latest_write_time(files);
+
+        if (vertex_code.empty() || fragment_code.empty())
         {
-            //load(vertex_code.c_str(), fragment_code.c_str(), geometry_code != "" ? geometry_code.c_str() : nullptr);
+            return false;
+        }
 
-            id = glCreateProgram();
+        // a reload started before this one finished is outdated
+        discard_build();
 
-            vertex_object = glCreateShader(GL_VERTEX_SHADER);
-            gpu_load(vertex_object, vertex_code.c_str());
+        build = std::make_shared<ShaderBuild>();
+        build->program = glCreateProgram();
 
-            fragment_object = glCreateShader(GL_FRAGMENT_SHADER);
-            gpu_load(fragment_object, fragment_code.c_str());
+        // linked from the same sources on this driver before : no compilation at all
+        build->cache_key = LINK_PROGRAM_CACHE->make_key({ vertex_code, fragment_code, geometry_code });
+        if (LINK_PROGRAM_CACHE->load(build->program, build->cache_key))
+        {
+            build->linked = true;
+            build->from_cache = true;
+            build->done = true;
+            install();
+            return true;
+        }
+        LINK_PROGRAM_CACHE->prepare(build->program);
+
+        build->sources[0] = std::move(vertex_code);
+        build->sources[1] = std::move(fragment_code);
+        build->sources[2] = std::move(geometry_code);
+        LINK_SHADER_COMPILER->submit(build);
+        LINK_SHADER_COMPILER->track(this);
+        return true;
+    }
 
-            if (!geometry_code.empty())
-            {
-                geometry_object = glCreateShader(GL_GEOMETRY_SHADER);
-                gpu_load(geometry_object, geometry_code.c_str());
-            }
+    bool Shader::wait()
+    {
+        if (build)
+        {
+            LINK_SHADER_COMPILER->finish(*build);
+            install();
+        }
+        return is_ready();
+    }
 
-            glAttachShader(id, vertex_object);
-            glAttachShader(id, fragment_object);
-            if (!geometry_code.empty())
-            {
-                glAttachShader(id, geometry_object);
-            }
+    bool Shader::poll()
+    {
+        if (!build)
+        {
+            return true;
+        }
+        if (!LINK_SHADER_COMPILER->is_done(*build))
+        {
+            return false;
+        }
 
-            glLinkProgram(id);
-            check_compile_errors(id, "PROGRAM");
+        LINK_SHADER_COMPILER->finish(*build);
+        install();
+        return true;
+    }
 
+    bool Shader::install()
+    {
+        const bool linked = build->linked;
+        fmt::print("Compiling shader {}... ", build->program);
 
-            glDeleteShader(vertex_object);
-            glDeleteShader(fragment_object);
-            if (!geometry_code.empty())
+        if (linked)
+        {
+            fmt::print("SUCCESS !\n");
+            glDeleteProgram(id);
+            id = build->program;
+            if (!build->from_cache)
             {
-                glDeleteShader(geometry_object);
+                LINK_PROGRAM_CACHE->store(id, build->cache_key);
             }
+            reflect_uniforms();
+        }
+        else
+        {
+            fmt::print("\n{}", build->log);
+            // the numbers before the line numbers of the errors
+            for (u32 i = 0; i < files.size(); ++i)
+            {
+                fmt::print("  source {} : {}\n", i, files[i]);
+            }
+            if (id != 0)
+            {
+                fmt::print("[SHADER::reload] {} keeps its previous program\n", fragment_path);
+            }
+            glDeleteProgram(build->program);
+        }
+
+        build.reset();
+        return linked;
+    }
 
-            success = true;
+    void Shader::discard_build()
+    {
+        if (build)
+        {
+            LINK_SHADER_COMPILER->finish(*build);
+            glDeleteProgram(build->program);
+            build.reset();
         }
+    }
 
-        return success;
+    bool Shader::sources_changed()
+    {
+        const std::filesystem::file_time_type time = latest_write_time(files);
+        if (time <= files_time)
+        {
+            return false;
+        }
+        files_time = time;
+        return true;
     }
 
     bool Shader::load(const char* vertex_code, const char* fragment_code)
@@ -126,6 +235,7 @@ namespace link
 
             glLinkProgram(id);
             check_compile_errors(id, "PROGRAM");
+            reflect_uniforms();
 
 
             glDeleteShader(vertex_object);
@@ -136,16 +246,103 @@ namespace link
         return false;
     }
 
-    std::vector<Uniform> Shader::get_uniforms()
+    namespace
+    {
+        // source is the source string number of the file in the #line directives, first_source the one of included[0]
+        void expand_includes(const std::string& path, u32 source, const std::string& code, u32 first_source, std::vector<std::string>& included, std::string& out)
+        {
+            std::istringstream lines(code);
+            std::string line;
+            u32 line_number = 0;
+            while (std::getline(lines, line))
+            {
+                line_number++;
+                const size_t directive = line.find_first_not_of(" \t");
+                if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0)
+                {
+                    out.append(line).append("\n");
+                    continue;
+                }
+
+                const size_t open = line.find('"', directive);
+                const size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+                const std::string include_path = close == std::string::npos ? std::string() : (std::filesystem::path(path).parent_path() / line.substr(open + 1, close - open - 1)).lexically_normal().string();
+                if (close == std::string::npos)
+                {
+                    fmt::print("[SHADER::include] Malformed include in {} : {}\n", path, line);
+                }
+                else if (std::find(included.begin(), included.end(), include_path) == included.end())
+                {
+                    included.push_back(include_path);
+                    if (!File::exists(include_path))
+                    {
+                        fmt::print("[SHADER::include] Failed to open {} included from {}\n", include_path, path);
+                    }
+                    else
+                    {
+                        std::string include_code;
+                        File::read(include_path, include_code);
+                        const u32 include_source = first_source + (u32)included.size() - 1;
+                        out.append(fmt::format("#line 1 {}\n", include_source));
+                        expand_includes(include_path, include_source, include_code, first_source, included, out);
+                    }
+                }
+
+                // compile errors report the line of the file they are in, not of the expanded source
+                out.append(fmt::format("#line {} {}\n", line_number + 1, source));
+            }
+        }
+    }
+
+    std::string Shader::preprocess(const std::string& path, const std::string& code, const std::string& defines, std::vector<std::string>* files)
+    {
+        if (code.empty())
+        {
+            return code;
+        }
+
+        // source string numbers follow the order of files, they are listed with the compile errors
+        const u32 first_source = files ? (u32)files->size() : 0;
+        std::vector<std::string> included{ std::filesystem::path(path).lexically_normal().string() };
+        std::string out;
+        out.reserve(code.size());
+        expand_includes(path, first_source, code, first_source, included, out);
+        if (files)
+        {
+            files->insert(files->end(), included.begin(), included.end());
+        }
+
+        // #version has to stay the first statement, the defines go right after it
+        std::string define_lines;
+        std::istringstream names(defines);
+        std::string name;
+        while (names >> name)
+        {
+            define_lines.append("#define ").append(name).append("\n");
+        }
+
+        // then the file continues at the line after #version, under its own source string number
+        const size_t version = out.find("#version");
+        const size_t line_end = version == std::string::npos ? std::string::npos : out.find('\n', version);
+        const size_t insert = line_end == std::string::npos ? 0 : line_end + 1;
+        const u32 next_line = 1 + (u32)std::count(out.begin(), out.begin() + insert, '\n');
+        define_lines.append(fmt::format("#line {} {}\n", next_line, first_source));
+        out.insert(insert, define_lines);
+        return out;
+    }
+
+    void Shader::reflect_uniforms()
     {
-        std::vector<Uniform> uniforms;
+        uniforms.clear();
+        uniform_indices.clear();
+        generation++;
 
         GLint count;
 
         GLint size; // size of the variable
         GLenum type; // type of the variable (float, vec3 or mat4, etc)
 
-        const GLsizei bufSize = 32; // maximum name length
+        const GLsizei bufSize = 64; // maximum name length
         GLchar name[bufSize]; // variable name in GLSL
         GLsizei length; // name length
 
@@ -154,11 +351,29 @@ namespace link
         for (u32 i = 0; i < count; i++)
         {
             glGetActiveUniform(id, (GLuint)i, bufSize, &length, &size, &type, name);
-            uniforms.emplace_back(i, type, name);
+
+            // uniforms in blocks have no location, they are set through their buffer
+            const GLint location = glGetUniformLocation(id, name);
+            if (location == -1)
+            {
+                continue;
+            }
+
+            uniform_indices[name] = (u32)uniforms.size();
+            uniforms.emplace_back((u32)location, type, name);
         }
+        //GL_FLOAT_VEC3 GL_SAMPLER_2D GL_FLOAT_MAT4 GL_FLOAT
+    }
 
+    std::vector<Uniform> Shader::get_uniforms()
+    {
         return uniforms;
-        //GL_FLOAT_VEC3 GL_SAMPLER_2D GL_FLOAT_MAT4 GL_FLOAT
+    }
+
+    i32 Shader::get_location(const std::string& name) const
+    {
+        auto iter = uniform_indices.find(name);
+        return iter != uniform_indices.end() ? (i32)uniforms[iter->second].id : -1;
     }
 
     void Shader::bind_ub(const std::string& block_name, const BindingPoint binding_point)
@@ -178,8 +393,7 @@ namespace link
     bool Shader::reload()
     {
         fmt::print("\n\nShader Reloading !!\n");
-        unload();
-        return load(vertex_path, fragment_path, geometry_path);
+        return load_async(vertex_path, fragment_path, geometry_path, defines);
     }
 
     void Shader::gpu_load(GLuint obj, const char* code)
@@ -191,7 +405,11 @@ namespace link
 
     void Shader::unload()
     {
+        discard_build();
         glDeleteProgram(id);
+        id = 0;
+        uniforms.clear();
+        uniform_indices.clear();
     }
 
 
@@ -202,70 +420,70 @@ namespace link
 
     u32 Shader::set(const std::string& _name, bool _value) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, _name.c_str());
+        u32 parameter_id = (u32)get_location(_name);
         glUniform1i(parameter_id, (int)_value);
         return parameter_id;
     }
 
     u32 Shader::set(const std::string& _name, int _value) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, _name.c_str());
+        u32 parameter_id = (u32)get_location(_name);
         glUniform1i(parameter_id, _value);
         return parameter_id;
     }
 
     u32 Shader::set(const std::string& _name, float _value) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, _name.c_str());
+        u32 parameter_id = (u32)get_location(_name);
         glUniform1f(parameter_id, _value);
         return parameter_id;
     }
 
     u32 Shader::set(const std::string& _name, float _x, float _y) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, _name.c_str());
+        u32 parameter_id = (u32)get_location(_name);
         glUniform2f(parameter_id, _x, _y);
         return parameter_id;
     }
 
     u32 Shader::set(const std::string& _name, float _x, float _y, float _z) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, _name.c_str());
+        u32 parameter_id = (u32)get_location(_name);
         glUniform3f(parameter_id, _x, _y, _z);
         return parameter_id;
     }
 
     u32 Shader::set(const std::string& _name, float x, float y, float z, float w) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, _name.c_str());
+        u32 parameter_id = (u32)get_location(_name);
         glUniform4f(parameter_id, x, y, z, w);
         return parameter_id;
     }
 
     u32 Shader::set(const std::string& _name, const glm::vec2& _vector) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, _name.c_str());
+        u32 parameter_id = (u32)get_location(_name);
         glUniform2f(parameter_id, _vector.x, _vector.y);
         return parameter_id;
     }
 
     u32 Shader::set(const std::string& _name, const glm::vec3& _vector) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, _name.c_str());
+        u32 parameter_id = (u32)get_location(_name);
         glUniform3f(parameter_id, _vector.x, _vector.y, _vector.z);
         return parameter_id;
     }
 
     u32 Shader::set(const std::string& name, const glm::vec4& v) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, name.c_str());
+        u32 parameter_id = (u32)get_location(name);
         glUniform4f(parameter_id, v.x, v.y, v.z, v.w);
         return parameter_id;
     }
 
     u32 Shader::set(const std::string& _name, const glm::mat4& _matrix) const
     {
-        u32 parameter_id = (u32)glGetUniformLocation(id, _name.c_str());
+        u32 parameter_id = (u32)get_location(_name);
         glUniformMatrix4fv(parameter_id, 1, GL_FALSE, glm::value_ptr(_matrix));
         return parameter_id;
     }
@@ -311,6 +529,31 @@ namespace link
         glUniformMatrix4fv(_parameterID, 1, GL_FALSE, glm::value_ptr(_matrix));
     }
 
+    void Shader::set(UniformHandle<int> handle, int value) const
+    {
+        glUniform1i(handle.location, value);
+    }
+    void Shader::set(UniformHandle<float> handle, float value) const
+    {
+        glUniform1f(handle.location, value);
+    }
+    void Shader::set(UniformHandle<glm::vec2> handle, const glm::vec2& value) const
+    {
+        glUniform2f(handle.location, value.x, value.y);
+    }
+    void Shader::set(UniformHandle<glm::vec3> handle, const glm::vec3& value) const
+    {
+        glUniform3f(handle.location, value.x, value.y, value.z);
+    }
+    void Shader::set(UniformHandle<glm::vec4> handle, const glm::vec4& value) const
+    {
+        glUniform4f(handle.location, value.x, value.y, value.z, value.w);
+    }
+    void Shader::set(UniformHandle<glm::mat4> handle, const glm::mat4& value) const
+    {
+        glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+
     void Shader::check_compile_errors(unsigned int shader, const std::string& type)
     {
         fmt::print("Compiling shader {}... ", shader);
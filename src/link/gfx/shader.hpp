@@ -7,6 +7,11 @@
 #include <string>
 #include <glm/glm.hpp>
 #include <vector>
+#include <unordered_map>
+#include <memory>
+#include <filesystem>
+
+#include <fmt/ostream.h>
 
 #include "ubo.hpp"
 #include "link/types.hpp"
@@ -14,6 +19,8 @@
 
 namespace link
 {
+    struct ShaderBuild;
+
     struct Uniform
     {
         Uniform(u32 id, GLenum type, const char* name)
@@ -21,11 +28,29 @@ namespace link
             , type(type)
             , name(name) {}
 
-        u32 id;
+        u32 id;         // location
         GLenum type;
         std::string name;
     };
 
+    // Location of a uniform resolved once, typed after the value it takes.
+    // Invalid handles are ignored when set, like a -1 location.
+    template<typename T>
+    struct UniformHandle
+    {
+        i32 location = -1;
+
+        inline bool is_valid() const { return location != -1; }
+    };
+
+    template<typename T> bool uniform_type_matches(GLenum type);
+    template<> inline bool uniform_type_matches<int>(GLenum type) { return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_2D || type == GL_SAMPLER_CUBE; }
+    template<> inline bool uniform_type_matches<float>(GLenum type) { return type == GL_FLOAT; }
+    template<> inline bool uniform_type_matches<glm::vec2>(GLenum type) { return type == GL_FLOAT_VEC2; }
+    template<> inline bool uniform_type_matches<glm::vec3>(GLenum type) { return type == GL_FLOAT_VEC3; }
+    template<> inline bool uniform_type_matches<glm::vec4>(GLenum type) { return type == GL_FLOAT_VEC4; }
+    template<> inline bool uniform_type_matches<glm::mat4>(GLenum type) { return type == GL_FLOAT_MAT4; }
+
     struct Shader
     {
         GLuint id;
@@ -33,12 +58,25 @@ namespace link
         Shader();
         ~Shader();
         void use() const;
-        bool load(const std::string& vertex_path, const std::string& fragment_path, const std::string& geometry_path = "");
+        // defines : names separated by spaces, each becomes a #define after the #version line of every stage
+        bool load(const std::string& vertex_path, const std::string& fragment_path, const std::string& geometry_path = "", const std::string& defines = "");
         bool load(const char* vertex_code, const char* fragment_code);
+        // returns once the compilation is started, the current program (if any) keeps drawing
+        // until the new one links, see ShaderCompiler. false when a source could not be read
+        bool load_async(const std::string& vertex_path, const std::string& fragment_path, const std::string& geometry_path = "", const std::string& defines = "");
 
+        // compiles in the background, a program failing to link leaves the previous one in place
         bool reload();
         void unload();
 
+        // blocks until the pending build is installed, true when the shader has a linked program
+        bool wait();
+        // installs the pending build when it is done, true once nothing is pending anymore
+        bool poll();
+        inline bool is_ready() const { return id != 0; }
+        // true once per change of the source files (includes too) since the last load
+        bool sources_changed();
+
         u32 set(const std::string& _name, bool _value) const;
         u32 set(const std::string& _name, int _value) const;
         u32 set(const std::string& _name, float _x) const;
@@ -61,15 +99,39 @@ namespace link
         void set(u32 _parameterID, const glm::vec4& _vector) const;
         void set(u32 _parameterID, const glm::mat4& _matrix) const;
 
+        // handles resolved against an older link (reload) have to be resolved again, see generation
+        template<typename T>
+        UniformHandle<T> get_uniform(const std::string& name) const;
+
+        void set(UniformHandle<int> handle, int value) const;
+        void set(UniformHandle<float> handle, float value) const;
+        void set(UniformHandle<glm::vec2> handle, const glm::vec2& value) const;
+        void set(UniformHandle<glm::vec3> handle, const glm::vec3& value) const;
+        void set(UniformHandle<glm::vec4> handle, const glm::vec4& value) const;
+        void set(UniformHandle<glm::mat4> handle, const glm::mat4& value) const;
+
+        // active uniforms, reflected once at link time
         std::vector<Uniform> get_uniforms();
+        i32 get_location(const std::string& name) const;
         //void bind_ub(const std::string& block_name, const GLuint binding_point);
         void bind_ub(const std::string& block_name, const BindingPoint binding_point);
 
         std::string vertex_path;
         std::string fragment_path;
         std::string geometry_path;
+        std::string defines;
+        // bumped every time the program is linked, locations may have moved
+        u32 generation;
+
+        // inlines #include "file" (relative to the including file, each file once) and adds the defines,
+        // #line directives keep the line numbers of every file, the source string number is its index in files
+        // files, when given, gets every file read (path first)
+        static std::string preprocess(const std::string& path, const std::string& code, const std::string& defines, std::vector<std::string>* files = nullptr);
 
     private:
+        void reflect_uniforms();
+        bool install();
+        void discard_build();
 
         void check_compile_errors(unsigned int _shader, const std::string& _type);
         void gpu_load(GLuint obj, const char* code);
@@ -78,5 +140,33 @@ namespace link
         GLuint vertex_object;
         GLuint fragment_object;
 
+        std::vector<Uniform> uniforms;
+        std::unordered_map<std::string, u32> uniform_indices;
+
+        std::shared_ptr<ShaderBuild> build;
+        std::vector<std::string> files;
+        std::filesystem::file_time_type files_time;
     };
+
+    template<typename T>
+    UniformHandle<T> Shader::get_uniform(const std::string& name) const
+    {
+        UniformHandle<T> handle;
+
+        auto iter = uniform_indices.find(name);
+        if (iter == uniform_indices.end())
+        {
+            return handle;
+        }
+
+        const Uniform& uniform = uniforms[iter->second];
+        if (!uniform_type_matches<T>(uniform.type))
+        {
+            fmt::print("WARNING :: Uniform {} is not of the requested type\n", name);
+            return handle;
+        }
+
+        handle.location = (i32)uniform.id;
+        return handle;
+    }
 }
\ No newline at end of file
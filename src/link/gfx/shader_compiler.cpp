@@ -0,0 +1,288 @@
+#include "shader_compiler.hpp"
+
+#include <algorithm>
+#include <SDL.h>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "shader.hpp"
+
+namespace link
+{
+    ShaderCompiler::ShaderCompiler()
+        : mode(Mode::Immediate)
+        , watch_interval_ms(500)
+        , window(nullptr)
+        , worker_context(nullptr)
+        , running(false)
+        , last_watch_ms(0)
+    {
+    }
+
+    ShaderCompiler::~ShaderCompiler()
+    {
+        shutdown();
+    }
+
+    void ShaderCompiler::init(SDL_Window* window, SDL_GLContext context)
+    {
+        this->window = window;
+
+        if (GLEW_KHR_parallel_shader_compile)
+        {
+            // let the driver pick its thread count
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+            mode = Mode::Parallel;
+        }
+        else
+        {
+            SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+            worker_context = SDL_GL_CreateContext(window);
+            SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+
+            // creating a context makes it current, the main thread keeps its own
+            SDL_GL_MakeCurrent(window, context);
+
+            if (worker_context)
+            {
+                running = true;
+                worker = std::thread(&ShaderCompiler::worker_loop, this);
+                mode = Mode::Worker;
+            }
+            else
+            {
+                fmt::print(stderr, "[SHADER::compiler] No shared context ({}), shaders compile on the main thread\n", SDL_GetError());
+            }
+        }
+
+        const char* names[] = { "immediate", "parallel (KHR_parallel_shader_compile)", "worker thread" };
+        fmt::print("ShaderCompiler started in {} mode\n", names[(u32)mode]);
+    }
+
+    void ShaderCompiler::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running)
+            {
+                return;
+            }
+            running = false;
+        }
+        wake.notify_all();
+        worker.join();
+
+        SDL_GL_DeleteContext(worker_context);
+        worker_context = nullptr;
+        mode = Mode::Immediate;
+    }
+
+    void ShaderCompiler::submit(const std::shared_ptr<ShaderBuild>& build)
+    {
+        build->done = false;
+
+        switch (mode)
+        {
+        case Mode::Parallel:
+        {
+            // returns right away, collect() waits for the completion status to be set
+            issue(*build);
+            break;
+        }
+        case Mode::Worker:
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(build);
+            }
+            wake.notify_one();
+            break;
+        }
+        case Mode::Immediate:
+        {
+            issue(*build);
+            collect(*build);
+            build->done = true;
+            break;
+        }
+        }
+    }
+
+    bool ShaderCompiler::is_done(ShaderBuild& build)
+    {
+        if (build.done)
+        {
+            return true;
+        }
+
+        if (mode == Mode::Parallel)
+        {
+            GLint complete = GL_FALSE;
+            glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &complete);
+            return complete == GL_TRUE;
+        }
+        return false;
+    }
+
+    void ShaderCompiler::finish(ShaderBuild& build)
+    {
+        if (mode == Mode::Worker)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&build]() { return build.done.load(); });
+            return;
+        }
+
+        if (!build.done)
+        {
+            collect(build);
+            build.done = true;
+        }
+    }
+
+    void ShaderCompiler::update()
+    {
+        // builds done since the last frame swap in, the others keep the previous program drawing
+        for (u32 i = 0; i < tracked.size();)
+        {
+            if (tracked[i]->poll())
+            {
+                tracked[i] = tracked.back();
+                tracked.pop_back();
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        const u32 now = SDL_GetTicks();
+        if (now - last_watch_ms < watch_interval_ms)
+        {
+            return;
+        }
+        last_watch_ms = now;
+
+        for (Shader* shader : watched)
+        {
+            if (shader->sources_changed())
+            {
+                fmt::print("[SHADER::watch] {} changed\n", shader->fragment_path);
+                shader->reload();
+            }
+        }
+    }
+
+    void ShaderCompiler::track(Shader* shader)
+    {
+        if (std::find(tracked.begin(), tracked.end(), shader) == tracked.end())
+        {
+            tracked.push_back(shader);
+        }
+    }
+
+    void ShaderCompiler::watch(Shader* shader)
+    {
+        if (std::find(watched.begin(), watched.end(), shader) == watched.end())
+        {
+            watched.push_back(shader);
+        }
+    }
+
+    void ShaderCompiler::forget(Shader* shader)
+    {
+        tracked.erase(std::remove(tracked.begin(), tracked.end(), shader), tracked.end());
+        watched.erase(std::remove(watched.begin(), watched.end(), shader), watched.end());
+    }
+
+    void ShaderCompiler::issue(ShaderBuild& build)
+    {
+        const GLenum types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+
+        for (u32 i = 0; i < 3; ++i)
+        {
+            if (build.sources[i].empty())
+            {
+                continue;
+            }
+
+            const char* code = build.sources[i].c_str();
+            build.stages[i] = glCreateShader(types[i]);
+            glShaderSource(build.stages[i], 1, &code, NULL);
+            glCompileShader(build.stages[i]);
+            glAttachShader(build.program, build.stages[i]);
+        }
+
+        glLinkProgram(build.program);
+    }
+
+    void ShaderCompiler::collect(ShaderBuild& build)
+    {
+        const char* names[] = { "VERTEX", "FRAGMENT", "GEOMETRY" };
+        char info_log[1024];
+
+        for (u32 i = 0; i < 3; ++i)
+        {
+            if (build.stages[i] == 0)
+            {
+                continue;
+            }
+
+            GLint success;
+            glGetShaderiv(build.stages[i], GL_COMPILE_STATUS, &success);
+            if (!success)
+            {
+                glGetShaderInfoLog(build.stages[i], 1024, NULL, info_log);
+                build.log += fmt::format("ERROR::SHADER_COMPILATION_ERROR of type: {}\n{}\n-------------------------------------------------------\n", names[i], info_log);
+            }
+
+            glDetachShader(build.program, build.stages[i]);
+            glDeleteShader(build.stages[i]);
+            build.stages[i] = 0;
+        }
+
+        GLint linked;
+        glGetProgramiv(build.program, GL_LINK_STATUS, &linked);
+        build.linked = linked == GL_TRUE;
+        if (!build.linked)
+        {
+            glGetProgramInfoLog(build.program, 1024, NULL, info_log);
+            build.log += fmt::format("ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM\n{}\n-------------------------------------------------------\n", info_log);
+        }
+    }
+
+    void ShaderCompiler::worker_loop()
+    {
+        SDL_GL_MakeCurrent(window, worker_context);
+
+        while (true)
+        {
+            std::shared_ptr<ShaderBuild> build;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return !running || !queue.empty(); });
+
+                if (!running && queue.empty())
+                {
+                    break;
+                }
+
+                build = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            issue(*build);
+            collect(*build);
+            // the program is complete for the main context once the commands are done here
+            glFinish();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                build->done = true;
+            }
+            finished.notify_all();
+        }
+
+        SDL_GL_MakeCurrent(window, nullptr);
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <GL/glew.h>
+#include <gl/GL.h>
+#include <SDL_video.h>
+
+#include "link/types.hpp"
+#include "link/singleton.hpp"
+
+namespace link
+{
+    struct Shader;
+
+    // One program being compiled and linked. The sources are expanded already (includes, defines).
+    // The program is not usable before the compiler reports the build done.
+    struct ShaderBuild
+    {
+        std::string sources[3];     // vertex, fragment, geometry (empty when unused)
+        u64 cache_key = 0;
+        GLuint program = 0;
+        GLuint stages[3] = { 0, 0, 0 };
+        std::atomic<bool> done{ false };
+        bool linked = false;
+        bool from_cache = false;    // linked from the program cache, nothing was compiled
+        std::string log;
+    };
+
+    // Compiles programs without stalling the frame :
+    // - Parallel : GL_KHR_parallel_shader_compile, the driver compiles on its own threads and the
+    //   completion status is polled, never the link status that would block
+    // - Worker : a thread with a context sharing objects with the main one compiles and links
+    // - Immediate : neither is available, builds are done when submitted, like a plain load
+    // update() installs finished builds in their shaders and reloads shaders whose files changed.
+    struct ShaderCompiler : Singleton<ShaderCompiler>
+    {
+        enum class Mode
+        {
+            Immediate,
+            Parallel,
+            Worker
+        };
+
+        ShaderCompiler();
+        ~ShaderCompiler();
+
+        // after glewInit, context is current on the calling thread
+        void init(SDL_Window* window, SDL_GLContext context);
+        void shutdown();
+
+        // build->program is created and prepared by the caller
+        void submit(const std::shared_ptr<ShaderBuild>& build);
+        bool is_done(ShaderBuild& build);
+        // blocks until the build is done, then reads its status and log
+        void finish(ShaderBuild& build);
+
+        // main thread, once per frame
+        void update();
+
+        // polled by update() until its build is installed
+        void track(Shader* shader);
+        // reloaded by update() when one of its files (includes too) is written
+        void watch(Shader* shader);
+        // a destroyed shader is dropped from both lists
+        void forget(Shader* shader);
+
+        Mode mode;
+        u32 watch_interval_ms;
+
+    private:
+        static void issue(ShaderBuild& build);
+        static void collect(ShaderBuild& build);
+        void worker_loop();
+
+        SDL_Window* window;
+        SDL_GLContext worker_context;
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable finished;
+        std::deque<std::shared_ptr<ShaderBuild>> queue;
+        bool running;
+
+        std::vector<Shader*> tracked;
+        std::vector<Shader*> watched;
+        u32 last_watch_ms;
+    };
+}
+
+#define LINK_SHADER_COMPILER link::ShaderCompiler::get()
@@ -12,12 +12,12 @@ namespace link
     {
         void init_stbi()
         {
-            static bool first_load = true;
-            if (first_load)
+            // textures are decoded from worker threads, the static initialization is thread safe
+            static const bool initialized = []()
             {
-                first_load = false;
                 stbi_set_flip_vertically_on_load(true);
-            }
+                return true;
+            }();
         }
     }
 
@@ -60,57 +60,73 @@ namespace link
 
     bool Texture2D::load(const std::string& file_path, TextureType t, bool generate_mipmaps)
     {
-        i32 components_count;
-        unsigned char* data = stbi_load(file_path.c_str(), &width, &height, &components_count, 0);
-        if (!data)
+        TextureData data;
+        if (!decode(file_path, data))
         {
             return false;
         }
-        else
-        {
-            if (id != 0)
-            {
-                clear();
-            }
 
-            this->file_path = file_path;
-            type = t;
-            this->generate_mipmaps = generate_mipmaps;
+        upload(data, file_path, t, generate_mipmaps);
+        return true;
+    }
 
-            if (components_count == 1)
-            {
-                format = GL_RED;
-            }
-            else if (components_count == 3)
-            {
-                format = GL_RGB;
-            }
-            else if (components_count == 4)
-            {
-                format = GL_RGBA;
-            }
+    bool Texture2D::decode(const std::string& file_path, TextureData& data)
+    {
+        init_stbi();
+        data.pixels = stbi_load(file_path.c_str(), &data.width, &data.height, &data.components, 0);
+        return data.pixels != nullptr;
+    }
 
-            glGenTextures(1, &id);
-            glBindTexture(GL_TEXTURE_2D, id);
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    void Texture2D::upload(const TextureData& data, const std::string& file_path, TextureType t, bool generate_mipmaps)
+    {
+        if (id != 0)
+        {
+            clear();
+        }
 
-            if (generate_mipmaps)
-            {
-                glGenerateMipmap(GL_TEXTURE_2D);
-            }
+        this->file_path = file_path;
+        type = t;
+        this->generate_mipmaps = generate_mipmaps;
+        width = data.width;
+        height = data.height;
 
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glBindTexture(GL_TEXTURE_2D, 0);
+        if (data.components == 1)
+        {
+            format = GL_RED;
+        }
+        else if (data.components == 3)
+        {
+            format = GL_RGB;
+        }
+        else if (data.components == 4)
+        {
+            format = GL_RGBA;
+        }
 
-            stbi_image_free(data);
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data.pixels);
 
-            fmt::print("Loaded {} at {}\n", file_path, id);
+        if (generate_mipmaps)
+        {
+            glGenerateMipmap(GL_TEXTURE_2D);
         }
 
-        return true;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        fmt::print("Loaded {} at {}\n", file_path, id);
+    }
+
+    TextureData::~TextureData()
+    {
+        if (pixels)
+        {
+            stbi_image_free(pixels);
+        }
     }
 
     Texture2D::~Texture2D()
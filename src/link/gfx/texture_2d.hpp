@@ -41,6 +41,20 @@ namespace link
         COUNT = 18,
     };
 
+    // pixels decoded from a file, safe to produce on any thread, uploaded on the gl thread by Texture2D::upload
+    struct TextureData
+    {
+        TextureData() : pixels(nullptr), width(0), height(0), components(0) {}
+        ~TextureData();
+        TextureData(const TextureData&) = delete;
+        TextureData& operator=(const TextureData&) = delete;
+
+        u8* pixels;
+        i32 width;
+        i32 height;
+        i32 components;
+    };
+
     struct Texture2D
     {
         Texture2D();
@@ -48,6 +62,9 @@ namespace link
         Texture2D(const std::string& file_path, TextureType type, bool generate_mipmaps = true);
         bool load(const std::string& file_path, TextureType type, bool generate_mipmaps = true);
 
+        static bool decode(const std::string& file_path, TextureData& data);
+        void upload(const TextureData& data, const std::string& file_path, TextureType type, bool generate_mipmaps = true);
+
         ~Texture2D();
 
         void bind(int texture_unit) const;
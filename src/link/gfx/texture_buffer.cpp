@@ -0,0 +1,70 @@
+#include "texture_buffer.hpp"
+
+namespace link
+{
+    TextureBuffer::TextureBuffer()
+        : buffer(0)
+        , texture(0)
+        , format(GL_R32UI)
+        , capacity(0)
+    {
+    }
+
+    TextureBuffer::~TextureBuffer()
+    {
+        clear();
+    }
+
+    void TextureBuffer::create(GLenum f)
+    {
+        format = f;
+        glGenBuffers(1, &buffer);
+        glGenTextures(1, &texture);
+    }
+
+    void TextureBuffer::upload(const void* data, size_t size)
+    {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+
+        // an empty buffer cannot back a texture, keep at least one texel around
+        const size_t storage = size > 0 ? size : 16;
+        if (storage > capacity)
+        {
+            capacity = storage;
+        }
+        glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        if (size > 0)
+        {
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+        }
+
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    }
+
+    bool TextureBuffer::set_data(size_t offset, size_t size, const void* data)
+    {
+        if (offset + size > capacity)
+        {
+            return false;
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, offset, size, data);
+        return true;
+    }
+
+    void TextureBuffer::bind(int texture_unit) const
+    {
+        glActiveTexture(texture_unit);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+    }
+
+    void TextureBuffer::clear()
+    {
+        glDeleteTextures(1, &texture);
+        glDeleteBuffers(1, &buffer);
+        texture = 0;
+        buffer = 0;
+        capacity = 0;
+    }
+}
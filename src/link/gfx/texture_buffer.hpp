@@ -0,0 +1,31 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <gl/GL.h>
+
+#include "link/types.hpp"
+
+namespace link
+{
+    // Buffer read in shaders through a samplerBuffer / usamplerBuffer, for arrays too large for a uniform block.
+    struct TextureBuffer
+    {
+        TextureBuffer();
+        ~TextureBuffer();
+
+        // format is the texel format, GL_RGBA32F, GL_R32UI...
+        void create(GLenum format);
+        // orphans the storage and uploads size bytes, the buffer grows as needed
+        void upload(const void* data, size_t size);
+        // keeps the storage, returns false (and writes nothing) when offset + size goes past it
+        bool set_data(size_t offset, size_t size, const void* data);
+        // texture_unit is GL_TEXTURE0 + n, like Texture2D::bind
+        void bind(int texture_unit) const;
+        void clear();
+
+        GLuint buffer;
+        GLuint texture;
+        GLenum format;
+        size_t capacity;
+    };
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <vector>
+#include <assert.h>
+
+#include "types.hpp"
+
+namespace link
+{
+    // Generational handle : index of a slot and the generation the slot had when the handle was given out.
+    // Freeing a slot bumps its generation, so handles to a removed element are detected as stale.
+    struct Handle
+    {
+        u32 index = U32_INVALID;
+        u32 generation = 0;
+
+        inline bool is_valid() const { return index != U32_INVALID; }
+        inline bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+        inline bool operator!=(const Handle& other) const { return !(*this == other); }
+    };
+
+    // Elements are stored contiguously, handles go through a slot table.
+    // Insertion, removal (swap and pop) and lookup are O(1); iteration is over the dense array.
+    template<typename T>
+    struct SlotMap
+    {
+        Handle insert(T value);
+        bool remove(Handle handle);
+        void clear();
+
+        T* get(Handle handle);
+        const T* get(Handle handle) const;
+        bool contains(Handle handle) const;
+
+        Handle get_handle(u32 dense_index) const;
+        u32 get_dense_index(Handle handle) const;
+
+        inline u32 size() const { return (u32)dense.size(); }
+        inline bool empty() const { return dense.empty(); }
+
+        inline T& operator[](u32 dense_index) { return dense[dense_index]; }
+        inline const T& operator[](u32 dense_index) const { return dense[dense_index]; }
+
+        inline typename std::vector<T>::iterator begin() { return dense.begin(); }
+        inline typename std::vector<T>::iterator end() { return dense.end(); }
+        inline typename std::vector<T>::const_iterator begin() const { return dense.begin(); }
+        inline typename std::vector<T>::const_iterator end() const { return dense.end(); }
+
+    private:
+        struct Slot
+        {
+            u32 dense_index;
+            u32 generation;
+        };
+
+        std::vector<T>      dense;
+        std::vector<u32>    dense_to_slot;
+        std::vector<Slot>   slots;
+        std::vector<u32>    free_slots;
+    };
+
+    template<typename T>
+    Handle SlotMap<T>::insert(T value)
+    {
+        u32 slot_index;
+        if (!free_slots.empty())
+        {
+            slot_index = free_slots.back();
+            free_slots.pop_back();
+        }
+        else
+        {
+            slot_index = (u32)slots.size();
+            slots.push_back({ U32_INVALID, 0 });
+        }
+
+        slots[slot_index].dense_index = (u32)dense.size();
+        dense.emplace_back(std::move(value));
+        dense_to_slot.push_back(slot_index);
+
+        return { slot_index, slots[slot_index].generation };
+    }
+
+    template<typename T>
+    bool SlotMap<T>::remove(Handle handle)
+    {
+        if (!contains(handle))
+        {
+            return false;
+        }
+
+        Slot& slot = slots[handle.index];
+        const u32 last = (u32)dense.size() - 1;
+
+        if (slot.dense_index != last)
+        {
+            dense[slot.dense_index] = std::move(dense[last]);
+            dense_to_slot[slot.dense_index] = dense_to_slot[last];
+            slots[dense_to_slot[last]].dense_index = slot.dense_index;
+        }
+
+        dense.pop_back();
+        dense_to_slot.pop_back();
+
+        slot.dense_index = U32_INVALID;
+        slot.generation++;
+        free_slots.push_back(handle.index);
+
+        return true;
+    }
+
+    template<typename T>
+    void SlotMap<T>::clear()
+    {
+        for (u32 slot_index : dense_to_slot)
+        {
+            slots[slot_index].dense_index = U32_INVALID;
+            slots[slot_index].generation++;
+            free_slots.push_back(slot_index);
+        }
+        dense.clear();
+        dense_to_slot.clear();
+    }
+
+    template<typename T>
+    T* SlotMap<T>::get(Handle handle)
+    {
+        return contains(handle) ? &dense[slots[handle.index].dense_index] : nullptr;
+    }
+
+    template<typename T>
+    const T* SlotMap<T>::get(Handle handle) const
+    {
+        return contains(handle) ? &dense[slots[handle.index].dense_index] : nullptr;
+    }
+
+    template<typename T>
+    bool SlotMap<T>::contains(Handle handle) const
+    {
+        return handle.index < slots.size()
+            && slots[handle.index].generation == handle.generation
+            && slots[handle.index].dense_index != U32_INVALID;
+    }
+
+    template<typename T>
+    Handle SlotMap<T>::get_handle(u32 dense_index) const
+    {
+        assert(dense_index < dense.size());
+        const u32 slot_index = dense_to_slot[dense_index];
+        return { slot_index, slots[slot_index].generation };
+    }
+
+    template<typename T>
+    u32 SlotMap<T>::get_dense_index(Handle handle) const
+    {
+        return contains(handle) ? slots[handle.index].dense_index : U32_INVALID;
+    }
+}
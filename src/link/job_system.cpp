@@ -0,0 +1,168 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <fmt/ostream.h>
+
+namespace link
+{
+    namespace
+    {
+        thread_local u32 thread_index = 0;
+    }
+
+    JobSystem::JobSystem()
+        : running(false)
+    {
+    }
+
+    JobSystem::~JobSystem()
+    {
+        shutdown();
+    }
+
+    void JobSystem::init(u32 worker_count)
+    {
+        if (running)
+        {
+            return;
+        }
+
+        if (worker_count == 0)
+        {
+            u32 hardware_count = std::thread::hardware_concurrency();
+            worker_count = hardware_count > 1 ? hardware_count - 1 : 0;
+        }
+        worker_count = std::min(worker_count, MAX_THREADS - 1);
+
+        running = true;
+        workers.reserve(worker_count);
+        for (u32 i = 0; i < worker_count; ++i)
+        {
+            workers.emplace_back(&JobSystem::worker_loop, this, i + 1);
+        }
+
+        fmt::print("JobSystem started with {} workers\n", worker_count);
+    }
+
+    void JobSystem::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running)
+            {
+                return;
+            }
+            running = false;
+        }
+        wake.notify_all();
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    void JobSystem::run(Counter& counter, Job job)
+    {
+        counter.pending.fetch_add(1);
+
+        if (workers.empty())
+        {
+            job();
+            counter.pending.fetch_sub(1);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back({ std::move(job), &counter });
+        }
+        wake.notify_one();
+    }
+
+    void JobSystem::wait(Counter& counter)
+    {
+        while (counter.pending.load() > 0)
+        {
+            if (!try_run_one())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::parallel_for(u32 count, u32 chunk_size, const RangeJob& job)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        chunk_size = std::max(chunk_size, 1u);
+        if (workers.empty() || count <= chunk_size)
+        {
+            job(0, count);
+            return;
+        }
+
+        Counter counter;
+        for (u32 begin = chunk_size; begin < count; begin += chunk_size)
+        {
+            u32 end = std::min(begin + chunk_size, count);
+            run(counter, [&job, begin, end]() { job(begin, end); });
+        }
+
+        // the calling thread takes the first chunk instead of idling
+        job(0, std::min(chunk_size, count));
+        wait(counter);
+    }
+
+    u32 JobSystem::get_thread_index()
+    {
+        return thread_index;
+    }
+
+    bool JobSystem::try_run_one()
+    {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.empty())
+            {
+                return false;
+            }
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        task.job();
+        task.counter->pending.fetch_sub(1);
+        return true;
+    }
+
+    void JobSystem::worker_loop(u32 index)
+    {
+        thread_index = index;
+
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return !running || !queue.empty(); });
+
+                if (!running && queue.empty())
+                {
+                    return;
+                }
+
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            task.job();
+            task.counter->pending.fetch_sub(1);
+        }
+    }
+}
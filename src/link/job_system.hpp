@@ -0,0 +1,65 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <vector>
+#include <deque>
+
+#include "types.hpp"
+#include "singleton.hpp"
+
+namespace link
+{
+    // Fixed pool of worker threads fed from a single queue.
+    // Threads waiting on a counter help draining the queue, so jobs may spawn and wait on other jobs.
+    struct JobSystem : Singleton<JobSystem>
+    {
+        using Job = std::function<void()>;
+        using RangeJob = std::function<void(u32 begin, u32 end)>;
+
+        struct Counter
+        {
+            std::atomic<u32> pending{ 0 };
+        };
+
+        JobSystem();
+        ~JobSystem();
+
+        // worker_count == 0 -> one worker per hardware thread, minus the main thread
+        void init(u32 worker_count = 0);
+        void shutdown();
+
+        void run(Counter& counter, Job job);
+        void wait(Counter& counter);
+
+        // splits [0, count) in chunks of chunk_size and blocks until every chunk is done
+        void parallel_for(u32 count, u32 chunk_size, const RangeJob& job);
+
+        inline u32 get_worker_count() const { return (u32)workers.size(); }
+
+        // 0 for the main thread (and any thread not owned by the pool), 1..worker_count for workers
+        static u32 get_thread_index();
+        static constexpr u32 MAX_THREADS = 64;
+
+    private:
+        struct Task
+        {
+            Job job;
+            Counter* counter;
+        };
+
+        bool try_run_one();
+        void worker_loop(u32 index);
+
+        std::vector<std::thread>    workers;
+        std::deque<Task>            queue;
+        std::mutex                  mutex;
+        std::condition_variable     wake;
+        bool                        running;
+    };
+}
+
+#define LINK_JOBS link::JobSystem::get()
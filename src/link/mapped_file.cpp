@@ -0,0 +1,144 @@
+#include "mapped_file.hpp"
+
+#include <fmt/ostream.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+// unistd.h is avoided on purpose, it declares a global link() clashing with the engine namespace
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace link
+{
+#ifdef _WIN32
+    MappedFile::MappedFile()
+        : data(nullptr)
+        , size(0)
+        , file(INVALID_HANDLE_VALUE)
+        , mapping(nullptr)
+    {
+    }
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            fmt::print("MappedFile : cannot open {}\n", path);
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            fmt::print("MappedFile : cannot map {}\n", path);
+            close();
+            return false;
+        }
+
+        data = (const u8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data)
+        {
+            close();
+            return false;
+        }
+
+        size = (u64)file_size.QuadPart;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (data)
+        {
+            UnmapViewOfFile(data);
+        }
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(file);
+        }
+
+        data = nullptr;
+        size = 0;
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+    }
+#else
+    MappedFile::MappedFile()
+        : data(nullptr)
+        , size(0)
+        , file(nullptr)
+    {
+    }
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+        file = fopen(path.c_str(), "rb");
+        if (!file)
+        {
+            fmt::print("MappedFile : cannot open {}\n", path);
+            return false;
+        }
+
+        struct stat file_stat;
+        if (fstat(fileno((FILE*)file), &file_stat) != 0 || file_stat.st_size == 0)
+        {
+            close();
+            return false;
+        }
+
+        void* view = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fileno((FILE*)file), 0);
+        if (view == MAP_FAILED)
+        {
+            fmt::print("MappedFile : cannot map {}\n", path);
+            close();
+            return false;
+        }
+
+        data = (const u8*)view;
+        size = (u64)file_stat.st_size;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (data)
+        {
+            munmap((void*)data, (size_t)size);
+        }
+        if (file)
+        {
+            fclose((FILE*)file);
+        }
+
+        data = nullptr;
+        size = 0;
+        file = nullptr;
+    }
+#endif
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+}
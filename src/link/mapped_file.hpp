@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "types.hpp"
+
+namespace link
+{
+    // Read only view of a whole file mapped in memory, unmapped on close or destruction.
+    struct MappedFile
+    {
+        MappedFile();
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        inline bool is_open() const { return data != nullptr; }
+
+        const u8* data;
+        u64 size;
+
+    private:
+        void* file;
+#ifdef _WIN32
+        void* mapping;
+#endif
+    };
+}
@@ -0,0 +1,449 @@
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace link
+{
+    namespace
+    {
+        // a balanced tree of 100k leaves is around 40 deep
+        constexpr u32 STACK_SIZE = 256;
+
+        // traversal stack, a degenerate tree going deeper spills to the heap instead of overflowing
+        struct NodeStack
+        {
+            inline bool empty() const { return count == 0; }
+
+            inline void push(u32 node)
+            {
+                if (count < STACK_SIZE)
+                {
+                    fixed[count] = node;
+                }
+                else
+                {
+                    spilled.push_back(node);
+                }
+                count++;
+            }
+
+            inline u32 pop()
+            {
+                count--;
+                if (count < STACK_SIZE)
+                {
+                    return fixed[count];
+                }
+                const u32 node = spilled.back();
+                spilled.pop_back();
+                return node;
+            }
+
+            u32 fixed[STACK_SIZE];
+            u32 count = 0;
+            std::vector<u32> spilled;
+        };
+    }
+
+    Bvh::Bvh()
+        : root(NULL_NODE)
+        , free_list(NULL_NODE)
+        , proxy_count(0)
+    {
+    }
+
+    u32 Bvh::allocate_node()
+    {
+        if (free_list == NULL_NODE)
+        {
+            nodes.emplace_back();
+            nodes.back().parent = NULL_NODE;
+            nodes.back().height = -1;
+            free_list = (u32)nodes.size() - 1;
+        }
+
+        const u32 node = free_list;
+        free_list = nodes[node].parent;
+        nodes[node].parent = NULL_NODE;
+        nodes[node].child1 = NULL_NODE;
+        nodes[node].child2 = NULL_NODE;
+        nodes[node].user_data = nullptr;
+        nodes[node].height = 0;
+        return node;
+    }
+
+    void Bvh::free_node(u32 node)
+    {
+        nodes[node].parent = free_list;
+        nodes[node].height = -1;
+        free_list = node;
+    }
+
+    u32 Bvh::insert(const AABB& bounds, void* user_data)
+    {
+        const u32 proxy = allocate_node();
+        const glm::vec3 fat(margin);
+        nodes[proxy].bounds = { bounds.min - fat, bounds.max + fat };
+        nodes[proxy].user_data = user_data;
+        insert_leaf(proxy);
+        proxy_count++;
+        return proxy;
+    }
+
+    void Bvh::remove(u32 proxy)
+    {
+        assert(proxy < nodes.size() && nodes[proxy].is_leaf() && nodes[proxy].height == 0);
+        remove_leaf(proxy);
+        free_node(proxy);
+        proxy_count--;
+    }
+
+    bool Bvh::move(u32 proxy, const AABB& bounds)
+    {
+        if (nodes[proxy].bounds.contains(bounds))
+        {
+            return false;
+        }
+
+        remove_leaf(proxy);
+        const glm::vec3 fat(margin);
+        nodes[proxy].bounds = { bounds.min - fat, bounds.max + fat };
+        insert_leaf(proxy);
+        return true;
+    }
+
+    void Bvh::clear()
+    {
+        nodes.clear();
+        root = NULL_NODE;
+        free_list = NULL_NODE;
+        proxy_count = 0;
+    }
+
+    u32 Bvh::get_height() const
+    {
+        return root == NULL_NODE ? 0 : (u32)nodes[root].height;
+    }
+
+    void Bvh::insert_leaf(u32 leaf)
+    {
+        if (root == NULL_NODE)
+        {
+            root = leaf;
+            nodes[root].parent = NULL_NODE;
+            return;
+        }
+
+        // walk down to the best sibling, the cost of a subtree is the area it would add to its ancestors
+        const AABB leaf_bounds = nodes[leaf].bounds;
+        u32 index = root;
+        while (!nodes[index].is_leaf())
+        {
+            const Node& node = nodes[index];
+            const f32 area = node.bounds.surface_area();
+            const f32 combined_area = AABB::merge(node.bounds, leaf_bounds).surface_area();
+
+            // cost of making a new parent for this node and the leaf
+            const f32 cost = 2.0f * combined_area;
+            // minimum cost of pushing the leaf further down
+            const f32 inheritance_cost = 2.0f * (combined_area - area);
+
+            f32 child_costs[2];
+            const u32 children[2] = { node.child1, node.child2 };
+            for (u32 i = 0; i < 2; ++i)
+            {
+                const Node& child = nodes[children[i]];
+                const f32 merged_area = AABB::merge(child.bounds, leaf_bounds).surface_area();
+                child_costs[i] = child.is_leaf()
+                    ? merged_area + inheritance_cost
+                    : merged_area - child.bounds.surface_area() + inheritance_cost;
+            }
+
+            if (cost < child_costs[0] && cost < child_costs[1])
+            {
+                break;
+            }
+            index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+        }
+
+        const u32 sibling = index;
+        const u32 old_parent = nodes[sibling].parent;
+        const u32 new_parent = allocate_node();
+        nodes[new_parent].parent = old_parent;
+        nodes[new_parent].bounds = AABB::merge(leaf_bounds, nodes[sibling].bounds);
+        nodes[new_parent].height = nodes[sibling].height + 1;
+        nodes[new_parent].child1 = sibling;
+        nodes[new_parent].child2 = leaf;
+        nodes[sibling].parent = new_parent;
+        nodes[leaf].parent = new_parent;
+
+        if (old_parent != NULL_NODE)
+        {
+            if (nodes[old_parent].child1 == sibling)
+            {
+                nodes[old_parent].child1 = new_parent;
+            }
+            else
+            {
+                nodes[old_parent].child2 = new_parent;
+            }
+        }
+        else
+        {
+            root = new_parent;
+        }
+
+        refit_from(nodes[leaf].parent);
+    }
+
+    void Bvh::remove_leaf(u32 leaf)
+    {
+        if (leaf == root)
+        {
+            root = NULL_NODE;
+            return;
+        }
+
+        const u32 parent = nodes[leaf].parent;
+        const u32 grand_parent = nodes[parent].parent;
+        const u32 sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        if (grand_parent != NULL_NODE)
+        {
+            if (nodes[grand_parent].child1 == parent)
+            {
+                nodes[grand_parent].child1 = sibling;
+            }
+            else
+            {
+                nodes[grand_parent].child2 = sibling;
+            }
+            nodes[sibling].parent = grand_parent;
+            free_node(parent);
+            refit_from(grand_parent);
+        }
+        else
+        {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+            free_node(parent);
+        }
+    }
+
+    void Bvh::refit_from(u32 index)
+    {
+        while (index != NULL_NODE)
+        {
+            index = balance(index);
+
+            Node& node = nodes[index];
+            node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+            node.bounds = AABB::merge(nodes[node.child1].bounds, nodes[node.child2].bounds);
+
+            index = node.parent;
+        }
+    }
+
+    // rotates a grand child up when the two subtrees of a differ in height by more than one, returns the new subtree root
+    u32 Bvh::balance(u32 a)
+    {
+        if (nodes[a].is_leaf() || nodes[a].height < 2)
+        {
+            return a;
+        }
+
+        const u32 b = nodes[a].child1;
+        const u32 c = nodes[a].child2;
+        const i32 difference = nodes[c].height - nodes[b].height;
+
+        if (difference > 1 || difference < -1)
+        {
+            // h is the higher child, promoted in place of a, l the lower one
+            const u32 h = difference > 1 ? c : b;
+            const u32 h1 = nodes[h].child1;
+            const u32 h2 = nodes[h].child2;
+
+            nodes[h].child1 = a;
+            nodes[h].parent = nodes[a].parent;
+            nodes[a].parent = h;
+
+            const u32 h_parent = nodes[h].parent;
+            if (h_parent != NULL_NODE)
+            {
+                if (nodes[h_parent].child1 == a)
+                {
+                    nodes[h_parent].child1 = h;
+                }
+                else
+                {
+                    nodes[h_parent].child2 = h;
+                }
+            }
+            else
+            {
+                root = h;
+            }
+
+            // the higher grand child stays under h, the other one takes the place of h under a
+            const bool keep_first = nodes[h1].height > nodes[h2].height;
+            const u32 kept = keep_first ? h1 : h2;
+            const u32 moved = keep_first ? h2 : h1;
+
+            nodes[h].child2 = kept;
+            if (h == c)
+            {
+                nodes[a].child2 = moved;
+            }
+            else
+            {
+                nodes[a].child1 = moved;
+            }
+            nodes[moved].parent = a;
+
+            const Node& a_child1 = nodes[nodes[a].child1];
+            const Node& a_child2 = nodes[nodes[a].child2];
+            nodes[a].bounds = AABB::merge(a_child1.bounds, a_child2.bounds);
+            nodes[a].height = 1 + std::max(a_child1.height, a_child2.height);
+
+            nodes[h].bounds = AABB::merge(nodes[a].bounds, nodes[kept].bounds);
+            nodes[h].height = 1 + std::max(nodes[a].height, nodes[kept].height);
+
+            return h;
+        }
+
+        return a;
+    }
+
+    template<typename Overlaps>
+    void Bvh::query(Overlaps overlaps, std::vector<void*>& results) const
+    {
+        if (root == NULL_NODE)
+        {
+            return;
+        }
+
+        NodeStack stack;
+        stack.push(root);
+
+        while (!stack.empty())
+        {
+            const Node& node = nodes[stack.pop()];
+            if (!overlaps(node.bounds))
+            {
+                continue;
+            }
+
+            if (node.is_leaf())
+            {
+                results.push_back(node.user_data);
+            }
+            else
+            {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+    }
+
+    void Bvh::query(const AABB& bounds, std::vector<void*>& results) const
+    {
+        query([&bounds](const AABB& node_bounds) { return node_bounds.intersects(bounds); }, results);
+    }
+
+    void Bvh::query(const Sphere& sphere, std::vector<void*>& results) const
+    {
+        query([&sphere](const AABB& node_bounds) { return node_bounds.intersects(sphere); }, results);
+    }
+
+    void Bvh::collect_leaves(u32 index, std::vector<void*>& results) const
+    {
+        NodeStack stack;
+        stack.push(index);
+
+        while (!stack.empty())
+        {
+            const Node& node = nodes[stack.pop()];
+            if (node.is_leaf())
+            {
+                results.push_back(node.user_data);
+            }
+            else
+            {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+    }
+
+    void Bvh::query(const Frustum& frustum, std::vector<void*>& results) const
+    {
+        if (root == NULL_NODE)
+        {
+            return;
+        }
+
+        NodeStack stack;
+        stack.push(root);
+
+        while (!stack.empty())
+        {
+            const u32 index = stack.pop();
+            const Node& node = nodes[index];
+
+            const Frustum::Result result = frustum.classify(node.bounds);
+            if (result == Frustum::Result::Outside)
+            {
+                continue;
+            }
+
+            // a subtree fully inside needs no more plane tests
+            if (result == Frustum::Result::Inside || node.is_leaf())
+            {
+                collect_leaves(index, results);
+            }
+            else
+            {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+    }
+
+    void Bvh::raycast(const Ray& ray, f32 max_distance, std::vector<RayHit>& results) const
+    {
+        const size_t first = results.size();
+        if (root == NULL_NODE)
+        {
+            return;
+        }
+
+        NodeStack stack;
+        stack.push(root);
+
+        while (!stack.empty())
+        {
+            const Node& node = nodes[stack.pop()];
+            const f32 distance = node.bounds.intersects(ray, max_distance);
+            if (distance < 0.0f)
+            {
+                continue;
+            }
+
+            if (node.is_leaf())
+            {
+                results.push_back({ node.user_data, distance });
+            }
+            else
+            {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+
+        std::sort(results.begin() + first, results.end(), [](const RayHit& a, const RayHit& b)
+        {
+            return a.distance < b.distance;
+        });
+    }
+}
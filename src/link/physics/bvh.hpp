@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include "link/types.hpp"
+#include "shapes.hpp"
+
+namespace link
+{
+    // Dynamic AABB tree. Leaves store enlarged ("fat") bounds so small moves do not touch the tree,
+    // insertion picks the sibling with the surface area heuristic and the tree is kept balanced with rotations,
+    // which keeps queries logarithmic with 100k+ proxies and updates mostly free.
+    // Proxies are stable ids for the lifetime of the leaf.
+    struct Bvh
+    {
+        static constexpr u32 NULL_NODE = U32_INVALID;
+
+        struct RayHit
+        {
+            void* user_data;
+            f32 distance;   // where the ray enters the fat bounds
+        };
+
+        Bvh();
+
+        u32 insert(const AABB& bounds, void* user_data);
+        void remove(u32 proxy);
+        // returns true when the proxy had to be reinserted, its fat bounds did not contain the new ones
+        bool move(u32 proxy, const AABB& bounds);
+        void clear();
+
+        inline void* get_user_data(u32 proxy) const { return nodes[proxy].user_data; }
+        inline const AABB& get_fat_bounds(u32 proxy) const { return nodes[proxy].bounds; }
+        inline u32 get_proxy_count() const { return proxy_count; }
+        u32 get_height() const;
+
+        // results are appended, the vectors are not cleared
+        void query(const AABB& bounds, std::vector<void*>& results) const;
+        void query(const Sphere& sphere, std::vector<void*>& results) const;
+        void query(const Frustum& frustum, std::vector<void*>& results) const;
+        // sorted by distance, a narrow phase on the user data is up to the caller
+        void raycast(const Ray& ray, f32 max_distance, std::vector<RayHit>& results) const;
+
+        f32 margin = 0.1f;
+
+    private:
+        struct Node
+        {
+            AABB bounds;
+            void* user_data;
+            u32 parent;     // next free node when in the free list
+            u32 child1;
+            u32 child2;
+            i32 height;     // leaf 0, free -1
+
+            inline bool is_leaf() const { return child1 == NULL_NODE; }
+        };
+
+        u32 allocate_node();
+        void free_node(u32 node);
+        void insert_leaf(u32 leaf);
+        void remove_leaf(u32 leaf);
+        u32 balance(u32 node);
+        void refit_from(u32 node);
+        void collect_leaves(u32 node, std::vector<void*>& results) const;
+
+        template<typename Overlaps>
+        void query(Overlaps overlaps, std::vector<void*>& results) const;
+
+        std::vector<Node> nodes;
+        u32 root;
+        u32 free_list;
+        u32 proxy_count;
+    };
+}
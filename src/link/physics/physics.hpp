@@ -31,10 +31,18 @@ namespace link
         {
             dynamicsWorld->addRigidBody(body);
         }
+
+        // removes the body from the world and deletes it along with its motion state
+        void remove_rigidbody(btRigidBody* body)
+        {
+            dynamicsWorld->removeRigidBody(body);
+            delete body->getMotionState();
+            delete body;
+        }
         
         void update()
         {
-            dynamicsWorld->stepSimulation(1.f / 60.f, 10);
+            dynamicsWorld->stepSimulation(time_step, 1, time_step);
         }
 
         void shutdown()
@@ -78,6 +86,8 @@ namespace link
             //collisionShapes.clear();
         }
 
+        // simulated seconds per update, one fixed step of the game simulation
+        float time_step = 1.f / 60.f;
 
     private:
         btDefaultCollisionConfiguration* collisionConfiguration;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <algorithm>
 
 #include "link/types.hpp"
 
@@ -16,5 +17,132 @@ namespace link
     {
         glm::vec3 center;
         f32 radius;
+
+        // still holds the transformed shape : the radius grows with the largest axis scale
+        inline Sphere transform(const glm::mat4& matrix) const
+        {
+            const f32 scale = std::max(std::max(glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1]))), glm::length(glm::vec3(matrix[2])));
+            return { glm::vec3(matrix * glm::vec4(center, 1.0f)), radius * scale };
+        }
+    };
+
+    struct AABB
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+
+        inline glm::vec3 center() const { return (min + max) * 0.5f; }
+        inline glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+        inline f32 surface_area() const
+        {
+            const glm::vec3 d = max - min;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        inline bool contains(const AABB& other) const
+        {
+            return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+        }
+
+        inline bool intersects(const AABB& other) const
+        {
+            return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+        }
+
+        inline bool intersects(const Sphere& sphere) const
+        {
+            const glm::vec3 closest = glm::clamp(sphere.center, min, max);
+            const glm::vec3 d = sphere.center - closest;
+            return glm::dot(d, d) <= sphere.radius * sphere.radius;
+        }
+
+        // slab test, distance along the ray where it enters the box (0 when it starts inside), negative on a miss
+        inline f32 intersects(const Ray& ray, f32 max_distance) const
+        {
+            const glm::vec3 inv_direction = 1.0f / ray.direction;
+            const glm::vec3 t0 = (min - ray.origin) * inv_direction;
+            const glm::vec3 t1 = (max - ray.origin) * inv_direction;
+            const glm::vec3 t_near = glm::min(t0, t1);
+            const glm::vec3 t_far = glm::max(t0, t1);
+            const f32 enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.0f));
+            const f32 exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, max_distance));
+            return enter <= exit ? enter : -1.0f;
+        }
+
+        static inline AABB merge(const AABB& a, const AABB& b)
+        {
+            return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+        }
+
+        // bounds of the box once transformed, by the absolute value of the rotation part (Arvo)
+        inline AABB transform(const glm::mat4& matrix) const
+        {
+            const glm::vec3 c = glm::vec3(matrix * glm::vec4(center(), 1.0f));
+            const glm::vec3 e = extents();
+            const glm::vec3 world_extents =
+                glm::abs(glm::vec3(matrix[0])) * e.x +
+                glm::abs(glm::vec3(matrix[1])) * e.y +
+                glm::abs(glm::vec3(matrix[2])) * e.z;
+            return { c - world_extents, c + world_extents };
+        }
+    };
+
+    // planes point inward, a point p is inside when dot(plane.xyz, p) + plane.w >= 0 for all of them
+    struct Frustum
+    {
+        enum class Result
+        {
+            Outside,
+            Intersects,
+            Inside
+        };
+
+        glm::vec4 planes[6];
+
+        // Gribb / Hartmann extraction from a projection * view matrix
+        static inline Frustum from_matrix(const glm::mat4& m)
+        {
+            Frustum frustum;
+            const glm::vec4 row0{ m[0][0], m[1][0], m[2][0], m[3][0] };
+            const glm::vec4 row1{ m[0][1], m[1][1], m[2][1], m[3][1] };
+            const glm::vec4 row2{ m[0][2], m[1][2], m[2][2], m[3][2] };
+            const glm::vec4 row3{ m[0][3], m[1][3], m[2][3], m[3][3] };
+            frustum.planes[0] = row3 + row0;
+            frustum.planes[1] = row3 - row0;
+            frustum.planes[2] = row3 + row1;
+            frustum.planes[3] = row3 - row1;
+            frustum.planes[4] = row3 + row2;
+            frustum.planes[5] = row3 - row2;
+            for (glm::vec4& plane : frustum.planes)
+            {
+                plane /= glm::length(glm::vec3(plane));
+            }
+            return frustum;
+        }
+
+        inline Result classify(const AABB& box) const
+        {
+            const glm::vec3 c = box.center();
+            const glm::vec3 e = box.extents();
+            Result result = Result::Inside;
+            for (const glm::vec4& plane : planes)
+            {
+                const glm::vec3 normal{ plane };
+                const f32 distance = glm::dot(normal, c) + plane.w;
+                const f32 radius = glm::dot(glm::abs(normal), e);
+                if (distance < -radius)
+                {
+                    return Result::Outside;
+                }
+                if (distance < radius)
+                {
+                    result = Result::Intersects;
+                }
+            }
+            return result;
+        }
+
+        inline bool intersects(const AABB& box) const { return classify(box) != Result::Outside; }
     };
 }
\ No newline at end of file
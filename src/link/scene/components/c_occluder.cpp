@@ -0,0 +1,82 @@
+#include "c_occluder.hpp"
+
+#include <imgui.h>
+
+#include "link/gfx/renderer.hpp"
+#include "link/binary.hpp"
+#include "link/config.hpp"
+#include "c_transform.hpp"
+#include "c_model_static.hpp"
+
+namespace link
+{
+    LINK_IMPLEMENT_RTTI(link, COccluder, Component);
+
+    COccluder::COccluder(SceneObject* owner)
+        : Component(owner, Type::Occluder)
+        , shape(Shape::Bounds)
+        , transform(nullptr)
+        , model(nullptr)
+    {
+        if (!LINK_CONFIG->headless)
+        {
+            render_handle = LINK_RENDERER->subscribe(this);
+        }
+    }
+
+    COccluder::~COccluder()
+    {
+        if (!LINK_CONFIG->headless)
+        {
+            LINK_RENDERER->unsubscribe_occluder(render_handle);
+        }
+    }
+
+    void COccluder::init()
+    {
+        refresh_dependencies();
+    }
+
+    void COccluder::refresh_dependencies()
+    {
+        transform = get_component<CTransform>();
+        model = get_component<CModel_Static>();
+    }
+
+    void COccluder::to_json(json& j)
+    {
+        Component::to_json(j);
+        j["shape"] = shape;
+    }
+
+    void COccluder::from_json(const json& j)
+    {
+        Component::from_json(j);
+        shape = j.contains("shape") ? j["shape"].get<Shape>() : Shape::Bounds;
+    }
+
+    void COccluder::to_binary(BinaryWriter& writer)
+    {
+        writer.write(shape);
+    }
+
+    void COccluder::from_binary(BinaryReader& reader)
+    {
+        reader.read(shape);
+    }
+
+#ifdef LINK_EDITOR_ENABLED
+    bool COccluder::debug_draw()
+    {
+        if (!Component::debug_draw())
+            return false;
+
+        ImGui::Combo("Shape", (i32*)&shape, "Bounds\0Mesh\0\0");
+        if (!model)
+        {
+            ImGui::Text("Needs a Static Model on the same object");
+        }
+        return true;
+    }
+#endif
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "link/scene/component.hpp"
+#include "link/editor/editor.hpp"
+#include "link/handle.hpp"
+
+namespace link
+{
+    struct CTransform;
+    struct CModel_Static;
+
+    // Draws the static model of its object into the renderer's occlusion buffer, hiding what is behind it.
+    // Only meant for solid, opaque objects (walls, floors, buildings) : the occluder has to stay inside the model.
+    struct COccluder : Component
+    {
+        enum class Shape : u32
+        {
+            Bounds,     // the bounds of the meshes, for box like models
+            Mesh,       // the triangles of the meshes, for low poly models
+        };
+
+        COccluder(SceneObject* owner);
+        ~COccluder();
+
+        void init() override;
+        void refresh_dependencies() override;
+
+        void to_json(json& j) override;
+        void from_json(const json& j) override;
+        void to_binary(BinaryWriter& writer) override;
+        void from_binary(BinaryReader& reader) override;
+
+        Shape shape;
+        CTransform* transform;
+        CModel_Static* model;
+        Handle render_handle;
+
+#ifdef LINK_EDITOR_ENABLED
+        bool debug_draw() override;
+#endif
+
+        LINK_DECLARE_RTTI
+    };
+}
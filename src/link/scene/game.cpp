@@ -8,6 +8,10 @@
 #include "scene.hpp"
 #include "link/file_system.hpp"
 #include "link/physics/physics.hpp"
+#include "link/gfx/renderer.hpp"
+#include "link/gfx/camera.hpp"
+#include "link/config.hpp"
+#include "link/timer.hpp"
 
 namespace link
 {
@@ -15,6 +19,31 @@ namespace link
 
     Game::Game()
     {
+        register_update_systems();
+    }
+
+    void Game::register_update_systems()
+    {
+        // only types with an update() doing actual work get a system
+        const UpdateSystem::Function update = [](Component* component) { component->update(); };
+
+        // spins its own transform
+        scheduler.add({ "Material PBR", Component::Type::Material_PBR,
+            component_mask(Component::Type::Material_PBR),
+            component_mask(Component::Type::Transform),
+            false, update });
+
+        // pushes the light color into the material of the object
+        scheduler.add({ "Light Source", Component::Type::LightSource,
+            component_mask(Component::Type::LightSource),
+            component_mask(Component::Type::Material) | component_mask(Component::Type::Material_PBR) | component_mask(Component::Type::Material_Phong),
+            false, update });
+
+        // reads back the bullet world
+        scheduler.add({ "Rigidbody", Component::Type::Rigidbody,
+            component_mask(Component::Type::Rigidbody),
+            0,
+            true, update });
     }
 
     void Game::create_scene(const std::string& name)
@@ -35,6 +64,7 @@ namespace link
         } while (rename);
 
         scenes.emplace_back(std::make_unique<Scene>(name));
+        streamer.bind(scenes);
     }
 
     void Game::init(const std::string& p)
@@ -46,6 +76,8 @@ namespace link
 
         path = p;
 
+        streamer.load(path + "world.json");
+
         for (const std::filesystem::directory_entry& p : std::filesystem::directory_iterator(path))
         {
             // clean path
@@ -54,13 +86,28 @@ namespace link
 
             std::string_view ext = Path::get_extention(path);
 
-            if (ext.compare("link") == 0)
+            // a binary scene only gets loaded on its own when there is no json next to it,
+            // otherwise the json scene picks whichever of the two is the most recent
+            const bool is_json = ext.compare("link") == 0;
+            const bool is_binary_only = ext.compare("linkb") == 0 && !File::exists(path.substr(0, path.size() - 1));
+            if (is_json || is_binary_only)
             {
-                fmt::print("Loading scene {}\n", path);
-                scenes.emplace_back(std::make_unique<Scene>(path, true));
+                scenes.emplace_back(std::make_unique<Scene>(path, true, false));
             }
 
         }
+
+        // streamed scenes wait for the viewer to come close, the others are loaded right away
+        // headless there is no viewer, the whole world is simulated
+        streamer.bind(scenes);
+        for (auto& scene : scenes)
+        {
+            if (!streamer.is_streamed(*scene) || LINK_CONFIG->headless)
+            {
+                fmt::print("Loading scene {}\n", scene->path);
+                loader.request(*scene);
+            }
+        }
     }
 
     void Game::play()
@@ -69,9 +116,19 @@ namespace link
         {
             for (auto& scene : scenes)
             {
-                scene->save();
-                scene->init();
+                if (!scene->is_loaded())
+                {
+                    scene->snapshot.clear();
+                    continue;
+                }
+                scene->snapshot.capture(*scene);
+                if (scene->is_active())
+                {
+                    scene->init();
+                }
             }
+            LINK_PHYSICS->time_step = (f32)LINK_TIME->simulation.step_s;
+            LINK_TIME->simulation.reset();
             state = State::Playing;
         }
         if (state == State::Paused)
@@ -82,13 +139,78 @@ namespace link
 
     void Game::update()
     {
-        if (state == State::Playing)
+        if (!LINK_CONFIG->headless && LINK_RENDERER->main_camera)
+        {
+            streamer.update(LINK_RENDERER->main_camera->position, loader);
+        }
+        loader.update();
+
+        if (is_playing())
         {
+            // scenes activated or deactivated by the streamer while playing
             for (auto& scene : scenes)
             {
-                scene->update();
+                if (scene->is_active() && !scene->initialized)
+                {
+                    scene->init();
+                }
+                else if (!scene->is_active() && scene->initialized)
+                {
+                    scene->stop();
+                }
+            }
+        }
+
+        for (auto& scene : scenes)
+        {
+            if (scene->is_active())
+            {
+                scene->flush_destroyed();
+            }
+        }
+
+        // the simulation runs in fixed steps, as many as the frame time allows
+        // headless, every update is exactly one step
+        if (state == State::Playing)
+        {
+            const u32 steps = LINK_CONFIG->headless ? 1 : LINK_TIME->simulation.advance(LINK_TIME->timer.dt_s);
+            for (u32 step = 0; step < steps; ++step)
+            {
+                for (auto& scene : scenes)
+                {
+                    if (scene->is_active())
+                    {
+                        scene->transforms.begin_step();
+                        scene->update(scheduler);
+                    }
+                }
+                LINK_PHYSICS->update();
+
+                for (auto& scene : scenes)
+                {
+                    if (scene->is_active())
+                    {
+                        scene->update_transforms();
+                    }
+                }
+            }
+        }
+
+        // edits made outside of the simulation (editor, loading) are shown as they are
+        for (auto& scene : scenes)
+        {
+            if (scene->is_active())
+            {
+                scene->update_transforms();
+                if (state == State::Playing && !LINK_CONFIG->headless)
+                {
+                    scene->transforms.interpolate(LINK_TIME->simulation.alpha);
+                }
+                else
+                {
+                    scene->transforms.snap();
+                }
             }
-            LINK_PHYSICS->update();
         }
     }
 
@@ -107,8 +229,19 @@ namespace link
             state = State::Stoped;
             for (auto& scene : scenes)
             {
-                scene->stop();
-                scene->load();
+                if (!scene->is_loaded())
+                {
+                    continue;
+                }
+                if (scene->initialized)
+                {
+                    scene->stop();
+                }
+                // scenes loaded while playing have no snapshot, they are as their file describes them
+                if (scene->snapshot.is_captured())
+                {
+                    scene->snapshot.restore(*scene);
+                }
             }
         }
     }
@@ -120,7 +253,10 @@ namespace link
         {
             for (auto& scene : scenes)
             {
-                scene->debug_update();
+                if (scene->is_active())
+                {
+                    scene->debug_update();
+                }
             }
         }
     }
@@ -143,6 +279,10 @@ namespace link
                 {
                     stop();
                 }
+                if (loader.is_loading())
+                {
+                    ImGui::ProgressBar(loader.get_progress(), { 200, 0 }, "Loading scenes");
+                }
                 ImGui::EndMenuBar();
             }
             ImGui::End();
@@ -150,8 +290,12 @@ namespace link
 
         for (auto& scene : scenes)
         {
-            scene->debug_draw();
+            if (scene->is_loaded())
+            {
+                scene->debug_draw();
+            }
         }
+        streamer.debug_draw();
     }
 #endif
 }
\ No newline at end of file
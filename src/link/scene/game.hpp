@@ -6,6 +6,9 @@
 
 #include "link/singleton.hpp"
 #include "link/editor/editor.hpp"
+#include "update_scheduler.hpp"
+#include "scene_loader.hpp"
+#include "world_streamer.hpp"
 
 namespace link
 {
@@ -23,11 +26,15 @@ namespace link
         std::vector<std::unique_ptr<Scene>> scenes;
         State state = State::Stoped;
         std::string path;
+        UpdateScheduler scheduler;
+        SceneLoader loader;
+        WorldStreamer streamer;
 
         Game();
         ~Game();
 
         void create_scene(const std::string& name);
+        void register_update_systems();
 
         void init(const std::string& path);
 
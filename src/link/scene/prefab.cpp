@@ -0,0 +1,297 @@
+#include "prefab.hpp"
+
+#include <filesystem>
+#include <fmt/ostream.h>
+
+#include "link/file.hpp"
+#include "link/mapped_file.hpp"
+#include "game.hpp"
+#include "scene.hpp"
+#include "scene_object.hpp"
+
+namespace link
+{
+    static_assert((u32)Component::Type::Count <= 32, "Prefab::bit packs the component types in a u32");
+
+    void Prefab::capture(SceneObject& obj)
+    {
+        name = obj.name.value;
+        records.clear();
+
+        BinaryWriter writer;
+        for (auto& kv : obj.components)
+        {
+            Component* component = kv.second.get();
+            if (component->type == Component::Type::Transform)
+            {
+                continue;
+            }
+
+            ComponentRecord record{ component->type, writer.get_position(), 0 };
+            component->to_binary(writer);
+            record.size = writer.get_position() - record.offset;
+            records.push_back(record);
+        }
+
+        data = std::move(writer.buffer);
+        strings = std::move(writer.strings);
+
+        std::vector<u8> table;
+        BinaryWriter table_writer;
+        table_writer.strings = strings;
+        table_writer.write_string_table(table);
+        set_string_table(std::move(table));
+    }
+
+    void Prefab::set_string_table(std::vector<u8> table)
+    {
+        string_table = std::move(table);
+        string_reader = BinaryReader();
+        string_reader.init_string_table(string_table.data(), (u32)string_table.size());
+    }
+
+    bool Prefab::save(const std::string& file_path) const
+    {
+        BinaryWriter body;
+        for (const ComponentRecord& record : records)
+        {
+            body.write(record);
+        }
+        body.write_bytes(data.data(), (u32)data.size());
+
+        Header header{};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.component_count = (u32)records.size();
+
+        // the name goes at the end of the table, the indices used by the component data do not move
+        BinaryWriter table_writer;
+        table_writer.strings = strings;
+        for (u32 i = 0; i < strings.size(); ++i)
+        {
+            table_writer.string_indices.emplace(strings[i], i);
+        }
+        header.name = table_writer.intern(name);
+
+        std::vector<u8> out(sizeof(Header));
+        header.strings_offset = (u32)out.size();
+        table_writer.write_string_table(out);
+        header.strings_size = (u32)out.size() - header.strings_offset;
+
+        header.body_offset = (u32)out.size();
+        header.body_size = body.get_position();
+        out.insert(out.end(), body.buffer.begin(), body.buffer.end());
+
+        std::memcpy(out.data(), &header, sizeof(Header));
+        return File::write(file_path, out.data(), (u32)out.size());
+    }
+
+    bool Prefab::load(const std::string& file_path)
+    {
+        MappedFile file;
+        if (!file.open(file_path) || file.size < sizeof(Header))
+        {
+            fmt::print("Prefab : cannot read {}\n", file_path);
+            return false;
+        }
+
+        Header header;
+        std::memcpy(&header, file.data, sizeof(Header));
+        if (header.magic != MAGIC || header.version != VERSION
+            || (u64)header.strings_offset + header.strings_size > file.size
+            || (u64)header.body_offset + header.body_size > file.size)
+        {
+            fmt::print("Prefab : {} is not a supported prefab file\n", file_path);
+            return false;
+        }
+
+        BinaryReader table;
+        if (!table.init_string_table(file.data + header.strings_offset, header.strings_size))
+        {
+            return false;
+        }
+
+        BinaryReader body(file.data + header.body_offset, header.body_size, &table);
+        records.resize(header.component_count);
+        for (ComponentRecord& record : records)
+        {
+            record = body.read<ComponentRecord>();
+        }
+        const u32 data_size = body.get_remaining();
+        const u8* bytes = body.read_bytes(data_size);
+        if (body.failed)
+        {
+            fmt::print("Prefab : {} is truncated\n", file_path);
+            return false;
+        }
+        for (const ComponentRecord& record : records)
+        {
+            if ((u32)record.type >= (u32)Component::Type::Count || (u64)record.offset + record.size > data_size)
+            {
+                fmt::print("Prefab : {} has a corrupted component record\n", file_path);
+                return false;
+            }
+        }
+        data.assign(bytes, bytes + data_size);
+
+        strings.clear();
+        for (u32 i = 0; i < table.string_count; ++i)
+        {
+            strings.emplace_back(table.get_string(i));
+        }
+        set_string_table(std::vector<u8>(file.data + header.strings_offset, file.data + header.strings_offset + header.strings_size));
+
+        path = file_path;
+        name = std::string(table.get_string(header.name));
+        return true;
+    }
+
+    SceneObject* Prefab::instantiate(Scene& scene) const
+    {
+        SceneObject* obj = scene.create_object(name);
+        Component::add_to(obj, Component::Type::Transform);
+        apply(*obj);
+        return obj;
+    }
+
+    void Prefab::apply(SceneObject& obj, u32 skip) const
+    {
+        obj.prefab = this;
+
+        // every component first so dependencies resolve whatever the record order
+        for (const ComponentRecord& record : records)
+        {
+            if (!(skip & bit(record.type)) && !Component::find_in(&obj, record.type))
+            {
+                Component::add_to(&obj, record.type);
+            }
+        }
+
+        for (const ComponentRecord& record : records)
+        {
+            if (skip & bit(record.type))
+            {
+                continue;
+            }
+
+            Component* component = Component::find_in(&obj, record.type);
+            BinaryReader reader(data.data() + record.offset, record.size, &string_reader);
+            component->refresh_dependencies();
+            component->from_binary(reader);
+        }
+    }
+
+    u32 Prefab::get_removed(SceneObject& obj) const
+    {
+        u32 removed = 0;
+        for (const ComponentRecord& record : records)
+        {
+            if (!Component::find_in(&obj, record.type))
+            {
+                removed |= bit(record.type);
+            }
+        }
+        return removed;
+    }
+
+    bool Prefab::is_override(Component& component) const
+    {
+        const ComponentRecord* record = find(component.type);
+        if (!record)
+        {
+            return true;
+        }
+
+        // same interning order as the prefab, equal components give the same bytes
+        BinaryWriter writer;
+        for (const std::string& string : strings)
+        {
+            writer.intern(string);
+        }
+        component.to_binary(writer);
+
+        return writer.get_position() != record->size
+            || std::memcmp(writer.buffer.data(), data.data() + record->offset, record->size) != 0;
+    }
+
+    const Prefab::ComponentRecord* Prefab::find(Component::Type type) const
+    {
+        for (const ComponentRecord& record : records)
+        {
+            if (record.type == type)
+            {
+                return &record;
+            }
+        }
+        return nullptr;
+    }
+
+    Prefab* PrefabLibrary::load(const std::string& path)
+    {
+        auto iter = prefabs.find(path);
+        if (iter != prefabs.end())
+        {
+            return iter->second.get();
+        }
+
+        std::unique_ptr<Prefab> prefab = std::make_unique<Prefab>();
+        if (!prefab->load(path))
+        {
+            return nullptr;
+        }
+        return prefabs.emplace(path, std::move(prefab)).first->second.get();
+    }
+
+    Prefab* PrefabLibrary::create(SceneObject& obj, const std::string& path)
+    {
+        std::unique_ptr<Prefab>& prefab = prefabs[path];
+        if (!prefab)
+        {
+            prefab = std::make_unique<Prefab>();
+        }
+
+        // overrides are found against the old template, before it is replaced
+        struct Instance
+        {
+            SceneObject* obj;
+            u32 skip;
+        };
+        std::vector<Instance> instances;
+        for (std::unique_ptr<Scene>& scene : LINK_GAME->scenes)
+        {
+            for (std::unique_ptr<SceneObject>& other : scene->scene_objects)
+            {
+                if (other.get() == &obj || other->prefab != prefab.get())
+                {
+                    continue;
+                }
+
+                u32 skip = prefab->get_removed(*other);
+                for (auto& kv : other->components)
+                {
+                    if (kv.second->type != Component::Type::Transform && prefab->is_override(*kv.second))
+                    {
+                        skip |= Prefab::bit(kv.second->type);
+                    }
+                }
+                instances.push_back({ other.get(), skip });
+            }
+        }
+
+        prefab->capture(obj);
+        prefab->path = path;
+        for (const Instance& instance : instances)
+        {
+            prefab->apply(*instance.obj, instance.skip);
+        }
+
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+        if (!prefab->save(path))
+        {
+            fmt::print("Prefab : cannot write {}\n", path);
+        }
+
+        obj.prefab = prefab.get();
+        return prefab.get();
+    }
+}
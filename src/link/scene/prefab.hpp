@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+#include "link/types.hpp"
+#include "link/singleton.hpp"
+#include "link/binary.hpp"
+#include "component.hpp"
+
+namespace link
+{
+    struct Scene;
+    struct SceneObject;
+
+    // Template of a scene object : the serialized data of its components, transform excluded.
+    // Instances are filled from it and keep a pointer to it. Shaders, models and textures are shared through
+    // the DataSystem caches, so an instance costs its components and nothing is compiled or loaded twice.
+    // Scene files only store the transform of an instance, the components that differ from the prefab and
+    // the prefab components the instance was stripped of.
+    //
+    // File : Header, string table, component_count records, then the components data back to back.
+    struct Prefab
+    {
+        static constexpr u32 MAGIC = 0x504B4E4C; // "LNKP"
+        static constexpr u32 VERSION = 1;
+
+        struct Header
+        {
+            u32 magic;
+            u32 version;
+            u32 name;               // string index
+            u32 component_count;
+            u32 strings_offset;
+            u32 strings_size;
+            u32 body_offset;
+            u32 body_size;
+        };
+
+        struct ComponentRecord
+        {
+            Component::Type type;
+            u32 offset;
+            u32 size;
+        };
+
+        void capture(SceneObject& obj);
+        bool save(const std::string& file_path) const;
+        bool load(const std::string& file_path);
+
+        // one bit per Component::Type
+        static constexpr u32 bit(Component::Type type) { return 1u << (u32)type; }
+
+        SceneObject* instantiate(Scene& scene) const;
+        // adds the components the object misses and fills every prefab component from the template,
+        // the types in skip are neither added nor filled
+        void apply(SceneObject& obj, u32 skip = 0) const;
+        // the prefab components obj does not have
+        u32 get_removed(SceneObject& obj) const;
+        // false when the component serializes exactly like the prefab one, it then does not need to be saved
+        bool is_override(Component& component) const;
+
+        std::string path;
+        std::string name;
+
+    private:
+        const ComponentRecord* find(Component::Type type) const;
+        void set_string_table(std::vector<u8> table);
+
+        std::vector<ComponentRecord> records;
+        std::vector<u8> data;
+        std::vector<std::string> strings;   // in index order, seeds the writer comparing instances
+        std::vector<u8> string_table;
+        BinaryReader string_reader;
+    };
+
+    struct PrefabLibrary : Singleton<PrefabLibrary>
+    {
+        Prefab* load(const std::string& path);
+        // captures obj as a new prefab (or over the existing one at path) and makes obj an instance of it,
+        // the other instances get the new template except for their overrides and removed components
+        Prefab* create(SceneObject& obj, const std::string& path);
+
+    private:
+        std::unordered_map<std::string, std::unique_ptr<Prefab>> prefabs;
+    };
+}
+
+#define LINK_PREFABS link::PrefabLibrary::get()
@@ -1,5 +1,6 @@
 #include "scene.hpp"
 
+#include <filesystem>
 #include <fmt/ostream.h>
 
 #ifdef LINK_EDITOR_ENABLED
@@ -8,10 +9,15 @@
 
 #include "scene_object.hpp"
 #include "component.hpp"
+#include "components/c_transform.hpp"
+#include "components/c_model_static.hpp"
+#include "link/gfx/mesh.hpp"
 #include "link/data_root.hpp"
 #include "link/gfx/camera.hpp"
 #include "link/gfx/renderer.hpp"
 #include "game.hpp"
+#include "update_scheduler.hpp"
+#include "scene_file.hpp"
 
 namespace link
 {
@@ -19,10 +25,13 @@ namespace link
 
     Scene::Scene(const std::string& n)
         : name("Scene name", n)
+        , components_dirty(true)
         , initialized(false)
+        , state(State::Active)
+        , memory_usage(0)
     {
-        path = fmt::format("{}{}{}.link", LINK_DATA_ROOT, "scenes/", name.value);
-        if (link::File::exists(path))
+        set_path(fmt::format("{}{}{}.link", LINK_DATA_ROOT, "scenes/", name.value));
+        if (link::File::exists(path) || link::File::exists(binary_path))
         {
             load();
         }
@@ -32,17 +41,32 @@ namespace link
         }
     }
 
-    Scene::Scene(const std::string& path, bool from_path)
+    Scene::Scene(const std::string& path, bool from_path, bool load_now)
         : name("Scene name", "")
+        , components_dirty(true)
         , initialized(false)
-        , path(path)
+        , state(State::Active)
+        , memory_usage(0)
     {
-        if (link::File::exists(path))
+        set_path(path);
+        if (!load_now)
+        {
+            state = State::Unloaded;
+            name.set(std::filesystem::path(this->path).stem().string());
+        }
+        else if (link::File::exists(this->path) || link::File::exists(binary_path))
         {
             load();
         }
     }
 
+    void Scene::set_path(const std::string& new_path)
+    {
+        const std::string stem = new_path.substr(0, new_path.find_last_of('.'));
+        path = stem + ".link";
+        binary_path = stem + ".linkb";
+    }
+
 
     void Scene::init()
     {
@@ -53,62 +77,30 @@ namespace link
         initialized = true;
     }
 
-    void Scene::update()
+    void Scene::update(UpdateScheduler& scheduler)
     {
-        // starting base in case we add a selected flag in scene object and dont need index during removal
-        //for (auto it = scene_objects.begin(); it != scene_objects.end();)
-        //{
-        //    bool deleted = false;
-        //    for (SceneObject* obj : marked_for_remove)
-        //    {
-        //        if (it->get() == obj)
-        //        {
-        //            it = scene_objects.erase(it);
-        //            deleted = true;
-        //            break;
-        //        }
-        //        //else
-        //        //{
-        //        //    ++it;
-        //        //}
-        //    }
-        //    if (!deleted)
-        //    {
-
-        //    }
-        //}
-
-        for (u32 i = 0; i < scene_objects.size();)
-        {
-            bool deleted = false;
-            for (SceneObject* obj : marked_for_remove)
-            {
-                if (scene_objects[i].get() == obj)
-                {
-                    deleted = true;
-                    remove_scene_object(i);
-#ifdef LINK_EDITOR_ENABLED
-                    if (selected > i)
-                    {
-                        selected--;
-                    }
-                    else if (selected == i)
-                    {
-                        selected = U64_INVALID;
-                    }
-#endif
-                    break;
-                }
-            }
-            if (!deleted) ++i;
+        for (auto& obj : scene_objects)
+        {
+            obj->update();
         }
 
-        marked_for_remove.clear();
+        scheduler.run(*this);
+    }
 
-        for (auto& obj : scene_objects)
+    void Scene::flush_destroyed()
+    {
+        if (destroy_queue.empty())
         {
-            obj->update();
+            return;
+        }
+
+        for (Handle handle : destroy_queue)
+        {
+            // stale or already destroyed handles are ignored by the slot map
+            scene_objects.remove(handle);
         }
+        destroy_queue.clear();
+        components_dirty = true;
     }
 
     void Scene::stop() 
@@ -120,11 +112,157 @@ namespace link
         }
     }
 
+    void Scene::update_transforms()
+    {
+        if (!transforms.update())
+        {
+            return;
+        }
+
+        const u32 count = transforms.get_count();
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (transforms.changed[i])
+            {
+                const CTransform* transform = transforms.order[i];
+                spatial.move(transform->spatial_proxy, transform->get_world_bounds());
+            }
+        }
+    }
+
+    SceneObject* Scene::raycast(const Ray& ray, f32 max_distance)
+    {
+        std::vector<Bvh::RayHit> hits;
+        spatial.raycast(ray, max_distance, hits);
+        return hits.empty() ? nullptr : (SceneObject*)hits.front().user_data;
+    }
+
+    void Scene::unload()
+    {
+        if (initialized)
+        {
+            stop();
+        }
+
+        scene_objects.clear();
+        destroy_queue.clear();
+        components_dirty = true;
+        snapshot.clear();
+        memory_usage = 0;
+        state = State::Unloaded;
+#ifdef LINK_EDITOR_ENABLED
+        selected = Handle();
+#endif
+    }
+
+    void Scene::refresh_memory_usage()
+    {
+        memory_usage = 0;
+        for (auto& obj : scene_objects)
+        {
+            memory_usage += sizeof(SceneObject) + obj->components.size() * sizeof(Component);
+
+            CModel_Static* model = obj->get_component<CModel_Static>();
+            if (!model)
+            {
+                continue;
+            }
+            for (Mesh* mesh : model->meshes)
+            {
+                memory_usage += mesh->vertices.size() * sizeof(Vertex) + mesh->indices.size() * sizeof(u32);
+            }
+        }
+    }
+
     void Scene::load()
     {
-        using nlohmann::json;
+        Source source;
+        read_source(source);
+        instantiate(source);
+    }
+
+    bool Scene::read_source(Source& source) const
+    {
+        const bool has_json = link::File::exists(path);
+        if (link::File::exists(binary_path)
+            && (!has_json || std::filesystem::last_write_time(binary_path) >= std::filesystem::last_write_time(path)))
+        {
+            if (source.binary.open(binary_path))
+            {
+                // fault the pages in here rather than on the thread instantiating the scene
+                volatile u8 touch = 0;
+                for (u64 offset = 0; offset < source.binary.size; offset += 4096)
+                {
+                    touch += source.binary.data[offset];
+                }
+                source.is_binary = true;
+                source.valid = true;
+                return true;
+            }
+            fmt::print("Scene {} : cannot read {}\n", name.value, binary_path);
+        }
 
+        if (has_json)
+        {
+            std::string content;
+            File2::read(path, content);
+
+            source.json_scene = json::parse(content, nullptr, false);
+            source.valid = !source.json_scene.is_discarded();
+            if (!source.valid)
+            {
+                fmt::print("Scene {} : cannot parse {}\n", name.value, path);
+            }
+        }
+
+        return source.valid;
+    }
+
+    void Scene::instantiate(Source& source)
+    {
         scene_objects.clear();
+        destroy_queue.clear();
+        components_dirty = true;
+
+        if (!source.valid)
+        {
+            return;
+        }
+
+        if (source.is_binary)
+        {
+            const bool loaded = SceneFile::read(*this, source.binary.data, source.binary.size);
+            source.binary.close();
+            if (loaded)
+            {
+                return;
+            }
+
+            fmt::print("Scene {} : cannot read {}\n", name.value, binary_path);
+            scene_objects.clear();
+            components_dirty = true;
+
+            if (link::File::exists(path))
+            {
+                import_json();
+            }
+            return;
+        }
+
+        from_json(source.json_scene);
+    }
+
+    void Scene::save()
+    {
+        if (!SceneFile::save(*this, binary_path))
+        {
+            fmt::print("Scene {} : cannot write {}\n", name.value, binary_path);
+        }
+    }
+
+    void Scene::import_json()
+    {
+        using nlohmann::json;
 
         std::string content;
         //link::File::read(path, content);
@@ -134,7 +272,7 @@ namespace link
         from_json(json_scene);
     }
 
-    void Scene::save()
+    void Scene::export_json()
     {
         using nlohmann::json;
 
@@ -148,7 +286,10 @@ namespace link
 
     SceneObject* Scene::create_object(const std::string& name)
     {
-        SceneObject* new_obj = scene_objects.emplace_back(std::make_unique<SceneObject>(this, name)).get();
+        Handle handle = scene_objects.insert(std::make_unique<SceneObject>(this, name));
+        SceneObject* new_obj = scene_objects.get(handle)->get();
+        new_obj->handle = handle;
+        components_dirty = true;
         new_obj->refresh_dependencies();
         if (initialized)
         {
@@ -159,24 +300,52 @@ namespace link
 
     void Scene::remove(SceneObject* obj)
     {
-        marked_for_remove.push_back(obj);
+        destroy_queue.push_back(obj->handle);
     }
 
     void Scene::remove_scene_object(u32 index)
     {
-        scene_objects.erase(scene_objects.begin() + index);
+        scene_objects.remove(scene_objects.get_handle(index));
+        components_dirty = true;
+    }
+
+    SceneObject* Scene::get(Handle handle)
+    {
+        std::unique_ptr<SceneObject>* obj = scene_objects.get(handle);
+        return obj ? obj->get() : nullptr;
+    }
+
+    bool Scene::contains(SceneObject* obj)
+    {
+        return obj && get(obj->handle) == obj;
     }
 
-    bool Scene::contains(SceneObject* obj1)
+    void Scene::refresh_component_lists()
     {
-        for (auto& obj2 : scene_objects)
+        if (!components_dirty)
         {
-            if (obj1 == obj2.get())
+            return;
+        }
+
+        for (std::vector<Component*>& components : components_by_type)
+        {
+            components.clear();
+        }
+
+        for (auto& obj : scene_objects)
+        {
+            for (auto& kv : obj->components)
             {
-                return true;
+                components_by_type[(u32)kv.second->type].push_back(kv.second.get());
             }
         }
-        return false;
+
+        components_dirty = false;
+    }
+
+    std::vector<Component*>& Scene::get_components(Component::Type type)
+    {
+        return components_by_type[(u32)type];
     }
 
     void Scene::to_json(json& j)
@@ -194,18 +363,68 @@ namespace link
     {
         name.from_json(j.at("name"), false);
 
+        std::vector<SceneObject*> loaded;
         for (u32 i = 0; i < j["scene_objects"].size(); ++i)
         {
             SceneObject* obj = create_object();
             obj->from_json(j["scene_objects"][i]);
+            loaded.push_back(obj);
+        }
+
+        resolve_parents(loaded);
+    }
+
+    void Scene::resolve_parents(const std::vector<SceneObject*>& loaded)
+    {
+        for (SceneObject* obj : loaded)
+        {
+            CTransform* transform = obj->get_component<CTransform>();
+            if (transform)
+            {
+                const u32 parent = transform->serialized_parent;
+                transform->set_parent(parent < loaded.size() ? loaded[parent]->get_component<CTransform>() : nullptr);
+            }
         }
     }
 
 #ifdef LINK_EDITOR_ENABLED
 
+    void Scene::debug_draw_object(SceneObject* obj)
+    {
+        const ImGuiTreeNodeFlags base_flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_SpanAvailWidth;
+
+        ImGuiTreeNodeFlags node_flags = base_flags;
+        if (obj->handle == selected)
+        {
+            node_flags |= ImGuiTreeNodeFlags_Selected;
+        }
+
+        CTransform* transform = obj->get_component<CTransform>();
+        const bool has_children = transform && !transform->children.empty();
+        if (!has_children)
+        {
+            node_flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+        }
+
+        bool open = ImGui::TreeNodeEx((void*)(intptr_t)obj->handle.index, node_flags, "%s", obj->name.value.c_str());
+        if (ImGui::IsItemClicked())
+        {
+            selected = obj->handle;
+        }
+
+        if (has_children && open)
+        {
+            for (CTransform* child : transform->children)
+            {
+                debug_draw_object(child->owner);
+            }
+            ImGui::TreePop();
+        }
+    }
+
     void Scene::debug_update()
     {
-        for (i32 i = 0; i < scene_objects.size(); ++i)
+        for (u32 i = 0; i < scene_objects.size(); ++i)
         {
             scene_objects[i]->debug_update();
         }
@@ -213,26 +432,17 @@ namespace link
 
     void Scene::debug_draw()
     {
-        const ImGuiTreeNodeFlags base_flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_SpanAvailWidth;
-
         if (ImGui::Begin("Scene Editor"))
         {
             if (ImGui::TreeNode(name.value.c_str()))
             {
-                for (i32 i = 0; i < scene_objects.size(); ++i)
+                for (u32 i = 0; i < scene_objects.size(); ++i)
                 {
-                    ImGuiTreeNodeFlags node_flags = base_flags;
-
-                    if (i == selected)
+                    // children are drawn under their parent
+                    CTransform* transform = scene_objects[i]->get_component<CTransform>();
+                    if (!transform || !transform->parent)
                     {
-                        node_flags |= ImGuiTreeNodeFlags_Selected;
-                    }
-
-                    node_flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
-                    ImGui::TreeNodeEx((void*)(intptr_t)i, node_flags, "%s", scene_objects[i]->name.value.c_str());
-                    if (ImGui::IsItemClicked())
-                    {
-                        selected = i;
+                        debug_draw_object(scene_objects[i].get());
                     }
                 }
                 ImGui::TreePop();
@@ -258,6 +468,11 @@ namespace link
                         load();
                     }
 
+                    if (EUtils::Button("Scene", "Export Json", { -1, -1, -1 }, { 120, 0 }))
+                    {
+                        export_json();
+                    }
+
                     ImGui::EndPopup();
                 }
             }
@@ -265,9 +480,9 @@ namespace link
             ImGui::End();
         }
 
-        if (selected != U64_INVALID)
+        if (SceneObject* selected_obj = get(selected))
         {
-            scene_objects[selected]->debug_draw();
+            selected_obj->debug_draw();
         }
         else
         {
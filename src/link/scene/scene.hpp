@@ -9,7 +9,13 @@
 
 #include "link/editor/editor.hpp"
 #include "link/types.hpp"
+#include "link/handle.hpp"
+#include "link/mapped_file.hpp"
+#include "link/physics/bvh.hpp"
 #include "link/editor/e_string.hpp"
+#include "component.hpp"
+#include "transform_hierarchy.hpp"
+#include "scene_snapshot.hpp"
 
 
 namespace link
@@ -19,41 +25,102 @@ namespace link
     struct Camera;
     struct SceneObject;
     struct Component;
+    struct UpdateScheduler;
 
     struct Scene
     {
-        using SceneObjects = std::vector<std::unique_ptr<SceneObject>>;
+        using SceneObjects = SlotMap<std::unique_ptr<SceneObject>>;
+
+        // Unloaded   no objects, only the paths are known
+        // Loading    handed to the SceneLoader
+        // Resident   objects in memory, neither updated nor rendered
+        // Active     updated and rendered
+        enum class State
+        {
+            Unloaded,
+            Loading,
+            Resident,
+            Active
+        };
+
+        // what read_source() prepares off the main thread : the mapped binary file or the parsed json
+        struct Source
+        {
+            MappedFile binary;
+            json json_scene;
+            bool is_binary = false;
+            bool valid = false;
+        };
 
         Scene(const std::string& name = "Default Scene Name");
-        Scene(const std::string& path, bool from_path);
+        Scene(const std::string& path, bool from_path, bool load_now = true);
 
         ~Scene();
 
         void init();
-        void update();
+        void update(UpdateScheduler& scheduler);
+        void flush_destroyed();
         void stop();
+        // the binary file is the working format, json is kept for interchange
+        // load() picks the binary file unless the json one is more recent
         void load();
+        // load() in two steps, read_source() does no gl work and may run on a worker
+        bool read_source(Source& source) const;
+        void instantiate(Source& source);
         void save();
+        void export_json();
+        void import_json();
+        void set_path(const std::string& new_path);
+        // back to Unloaded, the objects are destroyed right away
+        void unload();
+        inline bool is_loaded() const { return state == State::Resident || state == State::Active; }
+        inline bool is_active() const { return state == State::Active; }
+        // rough estimate, the mesh data of the models plus the objects themselves
+        void refresh_memory_usage();
 
         SceneObject* create_object(const std::string& name = "New Object");
+        // deferred, the object is destroyed by the next flush_destroyed()
         void remove(SceneObject* obj);
         void remove_scene_object(u32 index);
+        SceneObject* get(Handle handle);
         bool contains(SceneObject* obj);
+        // parents are saved as object indices, resolved once every object of the file exists
+        void resolve_parents(const std::vector<SceneObject*>& loaded);
+
+        // updates the world matrices, then moves the spatial proxies of the transforms that changed
+        void update_transforms();
+        // closest object whose world bounds the ray hits
+        SceneObject* raycast(const Ray& ray, f32 max_distance = std::numeric_limits<f32>::max());
+
+        // per type component lists iterated by the update systems, rebuilt when components are added or removed
+        void refresh_component_lists();
+        std::vector<Component*>& get_components(Component::Type type);
+        inline void set_components_dirty() { components_dirty = true; }
 
 #ifdef LINK_EDITOR_ENABLED
-        u64 selected = U64_INVALID;
+        Handle selected;
         void debug_update();
         void debug_draw();
+        void debug_draw_object(SceneObject* obj);
 #else
         void debug_update() {}
         inline void debug_draw() {}
 #endif
 
+        // declared before scene_objects, transforms unregister from them when their objects are destroyed
+        TransformHierarchy transforms;
+        Bvh spatial;                // world bounds of every transform, user data is the SceneObject*
         SceneObjects scene_objects;
-        std::vector<SceneObject*> marked_for_remove;
+        std::vector<Handle> destroy_queue;
+        std::vector<Component*> components_by_type[(u32)Component::Type::Count];
+        bool components_dirty;
         EString name;
         bool initialized;
-        std::string path;
+        State state;
+        u64 memory_usage;
+        SceneSnapshot snapshot;     // taken when entering play mode, restored when leaving it
+        std::string path;           // .link, json
+        std::string binary_path;    // .linkb
 
         void to_json(json& j);
         void from_json(const json& j);
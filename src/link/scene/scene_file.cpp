@@ -0,0 +1,229 @@
+#include "scene_file.hpp"
+
+#include <fmt/ostream.h>
+
+#include "link/binary.hpp"
+#include "link/file.hpp"
+#include "link/mapped_file.hpp"
+#include "scene.hpp"
+#include "scene_object.hpp"
+#include "component.hpp"
+#include "prefab.hpp"
+#include "link/data_root.hpp"
+#include "link/file_system.hpp"
+
+namespace link
+{
+    namespace SceneFile
+    {
+        void write(Scene& scene, std::vector<u8>& out)
+        {
+            scene.refresh_component_lists();
+
+            BinaryWriter body;
+
+            for (u32 i = 0; i < scene.scene_objects.size(); ++i)
+            {
+                body.write_string(scene.scene_objects[i]->name.value);
+            }
+
+            for (u32 i = 0; i < scene.scene_objects.size(); ++i)
+            {
+                SceneObject& obj = *scene.scene_objects[i];
+                body.write(obj.prefab ? body.intern(Path::get_path_relative(LINK_DATA_ROOT, obj.prefab->path)) : U32_INVALID);
+                body.write(obj.prefab ? obj.prefab->get_removed(obj) : 0u);
+            }
+
+            u32 block_count = 0;
+            std::vector<Component*> components;
+            for (u32 type = 0; type < (u32)Component::Type::Count; ++type)
+            {
+                // components of prefab instances equal to the prefab ones come back with the prefab
+                components.clear();
+                for (Component* component : scene.get_components((Component::Type)type))
+                {
+                    const Prefab* prefab = component->owner->prefab;
+                    if (!prefab || component->type == Component::Type::Transform || prefab->is_override(*component))
+                    {
+                        components.push_back(component);
+                    }
+                }
+                if (components.empty())
+                {
+                    continue;
+                }
+
+                const u32 header_position = body.get_position();
+                body.write(BlockHeader{ type, (u32)components.size(), 0 });
+
+                for (Component* component : components)
+                {
+                    body.write(scene.scene_objects.get_dense_index(component->owner->handle));
+                }
+
+                const u32 data_start = body.get_position();
+                for (Component* component : components)
+                {
+                    component->to_binary(body);
+                }
+
+                body.patch(header_position, BlockHeader{ type, (u32)components.size(), body.get_position() - data_start });
+                block_count++;
+            }
+
+            Header header{};
+            header.magic = MAGIC;
+            header.version = VERSION;
+            header.name = body.intern(scene.name.value);
+            header.object_count = scene.scene_objects.size();
+            header.block_count = block_count;
+
+            out.clear();
+            out.resize(sizeof(Header));
+
+            header.strings_offset = (u32)out.size();
+            body.write_string_table(out);
+            header.strings_size = (u32)out.size() - header.strings_offset;
+
+            header.body_offset = (u32)out.size();
+            header.body_size = body.get_position();
+            out.insert(out.end(), body.buffer.begin(), body.buffer.end());
+
+            std::memcpy(out.data(), &header, sizeof(Header));
+        }
+
+        bool read(Scene& scene, const u8* data, u64 size)
+        {
+            Header header;
+            if (size < sizeof(Header))
+            {
+                return false;
+            }
+            std::memcpy(&header, data, sizeof(Header));
+
+            if (header.magic != MAGIC || header.version < VERSION_NO_PREFABS || header.version > VERSION)
+            {
+                fmt::print("Scene file : unsupported format (magic {:x}, version {})\n", header.magic, header.version);
+                return false;
+            }
+            if ((u64)header.strings_offset + header.strings_size > size || (u64)header.body_offset + header.body_size > size)
+            {
+                fmt::print("Scene file : truncated file\n");
+                return false;
+            }
+
+            BinaryReader strings;
+            if (!strings.init_string_table(data + header.strings_offset, header.strings_size))
+            {
+                return false;
+            }
+            BinaryReader body(data + header.body_offset, header.body_size, &strings);
+
+            scene.name.set(std::string(strings.get_string(header.name)));
+
+            std::vector<SceneObject*> loaded;
+            loaded.reserve(header.object_count);
+            for (u32 i = 0; i < header.object_count && !body.failed; ++i)
+            {
+                loaded.push_back(scene.create_object(std::string(body.read_string())));
+            }
+
+            if (header.version >= VERSION_NO_PREFAB_REMOVALS)
+            {
+                for (u32 i = 0; i < header.object_count && !body.failed; ++i)
+                {
+                    const u32 prefab_path = body.read<u32>();
+                    const u32 removed = header.version >= VERSION ? body.read<u32>() : 0;
+                    if (prefab_path == U32_INVALID)
+                    {
+                        continue;
+                    }
+
+                    const std::string path = std::string(LINK_DATA_ROOT).append(strings.get_string(prefab_path));
+                    if (const Prefab* prefab = LINK_PREFABS->load(path))
+                    {
+                        prefab->apply(*loaded[i], removed);
+                    }
+                }
+            }
+
+            struct Block
+            {
+                BlockHeader header;
+                const u8* owners;
+                BinaryReader data;
+            };
+
+            // first pass creates every component so dependencies resolve whatever the block order
+            std::vector<Block> blocks;
+            blocks.reserve(header.block_count);
+            for (u32 i = 0; i < header.block_count && !body.failed; ++i)
+            {
+                Block block;
+                block.header = body.read<BlockHeader>();
+                block.owners = body.read_bytes(block.header.count * sizeof(u32));
+                block.data = BinaryReader(body.read_bytes(block.header.data_size), block.header.data_size, &strings);
+                if (body.failed || block.header.type >= (u32)Component::Type::Count)
+                {
+                    fmt::print("Scene file : corrupted component block\n");
+                    return false;
+                }
+
+                for (u32 c = 0; c < block.header.count; ++c)
+                {
+                    u32 owner;
+                    std::memcpy(&owner, block.owners + c * sizeof(u32), sizeof(u32));
+                    if (owner < loaded.size() && !Component::find_in(loaded[owner], (Component::Type)block.header.type))
+                    {
+                        Component::add_to(loaded[owner], (Component::Type)block.header.type);
+                    }
+                }
+                blocks.push_back(block);
+            }
+
+            for (Block& block : blocks)
+            {
+                for (u32 c = 0; c < block.header.count; ++c)
+                {
+                    u32 owner;
+                    std::memcpy(&owner, block.owners + c * sizeof(u32), sizeof(u32));
+                    Component* component = owner < loaded.size() ? Component::find_in(loaded[owner], (Component::Type)block.header.type) : nullptr;
+                    if (!component)
+                    {
+                        fmt::print("Scene file : component without owner, the rest of the block is skipped\n");
+                        break;
+                    }
+
+                    component->refresh_dependencies();
+                    component->from_binary(block.data);
+                }
+
+                if (block.data.failed)
+                {
+                    fmt::print("Scene file : component block {} is truncated\n", Component::TypeNames[block.header.type]);
+                    return false;
+                }
+            }
+
+            scene.resolve_parents(loaded);
+            return !body.failed;
+        }
+
+        bool save(Scene& scene, const std::string& path)
+        {
+            std::vector<u8> content;
+            write(scene, content);
+            return File::write(path, content.data(), (u32)content.size());
+        }
+
+        bool load(Scene& scene, const std::string& path)
+        {
+            MappedFile file;
+            if (!file.open(path))
+            {
+                return false;
+            }
+            return read(scene, file.data, file.size);
+        }
+    }
+}
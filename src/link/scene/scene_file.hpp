@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "link/types.hpp"
+
+namespace link
+{
+    struct Scene;
+
+    // Binary scene format.
+    // Header, string table, object names, object prefabs (since version 2, with their removed components since 3),
+    // then one block per component type :
+    // block header, the index of the owning object of every component, then the components data back to back.
+    // Prefab instances are written as their prefab path, their transform and the components overriding the prefab.
+    // Strings are indices in the string table so a mapped file is read in place, without any parsing step.
+    namespace SceneFile
+    {
+        constexpr u32 MAGIC = 0x534B4E4C; // "LNKS"
+        constexpr u32 VERSION = 3;
+        constexpr u32 VERSION_NO_PREFAB_REMOVALS = 2;
+        constexpr u32 VERSION_NO_PREFABS = 1;
+
+        struct Header
+        {
+            u32 magic;
+            u32 version;
+            u32 name;               // string index
+            u32 object_count;
+            u32 block_count;
+            u32 strings_offset;
+            u32 strings_size;
+            u32 body_offset;
+            u32 body_size;
+        };
+
+        struct BlockHeader
+        {
+            u32 type;               // Component::Type
+            u32 count;
+            u32 data_size;
+        };
+
+        void write(Scene& scene, std::vector<u8>& out);
+        bool read(Scene& scene, const u8* data, u64 size);
+
+        bool save(Scene& scene, const std::string& path);
+        bool load(Scene& scene, const std::string& path);
+    }
+}
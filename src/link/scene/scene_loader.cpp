@@ -0,0 +1,147 @@
+#include "scene_loader.hpp"
+
+#include <algorithm>
+#include <fmt/ostream.h>
+
+#include "link/data_system.hpp"
+
+namespace link
+{
+    SceneLoader::~SceneLoader()
+    {
+        for (auto& request : requests)
+        {
+            LINK_JOBS->wait(request->counter);
+        }
+    }
+
+    void SceneLoader::request(Scene& scene, bool activate)
+    {
+        for (auto& request : requests)
+        {
+            if (request->scene == &scene && (request->stage == Stage::Reading || request->stage == Stage::Instantiating))
+            {
+                request->activate = request->activate || activate;
+                return;
+            }
+        }
+
+        if (scene.state != Scene::State::Unloaded)
+        {
+            return;
+        }
+
+        requests.emplace_back(std::make_unique<Request>());
+        Request* request = requests.back().get();
+        request->scene = &scene;
+        request->activate = activate;
+        scene.state = Scene::State::Loading;
+
+        LINK_JOBS->run(request->counter, [request]()
+        {
+            request->read_ok = request->scene->read_source(request->source);
+        });
+    }
+
+    void SceneLoader::update()
+    {
+        bool instantiated = false;
+
+        for (auto& request : requests)
+        {
+            switch (request->stage)
+            {
+            case Stage::Reading:
+                if (request->counter.pending.load() == 0)
+                {
+                    request->stage = request->read_ok ? Stage::Instantiating : Stage::Failed;
+                    if (!request->read_ok)
+                    {
+                        fmt::print("Failed to load scene {}\n", request->scene->path);
+                        request->scene->state = Scene::State::Unloaded;
+                    }
+                }
+                break;
+
+            case Stage::Instantiating:
+                // one scene per frame, the rest of the work is spread over the next ones
+                if (!instantiated)
+                {
+                    instantiated = true;
+
+                    request->assets_begin = LINK_DATA_SYSTEM->get_async_requested();
+                    LINK_DATA_SYSTEM->async_loads = true;
+                    request->scene->instantiate(request->source);
+                    LINK_DATA_SYSTEM->async_loads = false;
+
+                    request->scene->state = request->activate ? Scene::State::Active : Scene::State::Resident;
+                    request->stage = Stage::Streaming;
+                }
+                break;
+
+            case Stage::Streaming:
+                if (!LINK_DATA_SYSTEM->has_pending_loads())
+                {
+                    fmt::print("Loaded scene {}\n", request->scene->path);
+                    // the scene may have been unloaded again while its assets were streaming
+                    if (request->scene->is_loaded())
+                    {
+                        request->scene->refresh_memory_usage();
+                    }
+                    request->stage = Stage::Done;
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        LINK_DATA_SYSTEM->process_uploads(upload_budget_ms);
+
+        if (!is_loading())
+        {
+            requests.clear();
+        }
+    }
+
+    bool SceneLoader::is_loading() const
+    {
+        return std::any_of(requests.begin(), requests.end(), [](const std::unique_ptr<Request>& request)
+        {
+            return request->stage != Stage::Done && request->stage != Stage::Failed;
+        });
+    }
+
+    f32 SceneLoader::get_progress() const
+    {
+        if (requests.empty())
+        {
+            return 1.0f;
+        }
+
+        f32 progress = 0.0f;
+        for (auto& request : requests)
+        {
+            progress += get_progress(*request);
+        }
+        return progress / (f32)requests.size();
+    }
+
+    f32 SceneLoader::get_progress(const Request& request) const
+    {
+        switch (request.stage)
+        {
+        case Stage::Reading:        return 0.0f;
+        case Stage::Instantiating:  return 0.25f;
+        case Stage::Streaming:
+        {
+            // asset counters are shared by every request, close enough for a progress bar
+            const u32 requested = LINK_DATA_SYSTEM->get_async_requested() - request.assets_begin;
+            const u32 completed = std::min(LINK_DATA_SYSTEM->get_async_completed() - std::min(LINK_DATA_SYSTEM->get_async_completed(), request.assets_begin), requested);
+            return requested == 0 ? 1.0f : 0.25f + 0.75f * (f32)completed / (f32)requested;
+        }
+        default:                    return 1.0f;
+        }
+    }
+}
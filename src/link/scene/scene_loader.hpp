@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+
+#include "link/types.hpp"
+#include "link/job_system.hpp"
+#include "scene.hpp"
+
+namespace link
+{
+    // Loads scenes without stalling the main thread :
+    //  Reading         a worker maps the binary file or parses the json
+    //  Instantiating   objects and components are created on the main thread, one scene per update,
+    //                  with models and textures requested asynchronously (decoded on the workers)
+    //  Streaming       decoded assets are uploaded to the gpu by process_uploads, a few ms per frame
+    // The scene is usable once instantiated (Resident or Active), its assets keep streaming in while it is in use.
+    struct SceneLoader
+    {
+        enum class Stage
+        {
+            Reading,
+            Instantiating,
+            Streaming,
+            Done,
+            Failed
+        };
+
+        ~SceneLoader();
+
+        // the scene has to be Unloaded and outlive the request, requesting it again while loading only updates activate
+        void request(Scene& scene, bool activate = true);
+        void update();
+
+        bool is_loading() const;
+        // 0..1 over every request still tracked
+        f32 get_progress() const;
+
+        f64 upload_budget_ms = 4.0;
+
+    private:
+        struct Request
+        {
+            Scene* scene;
+            Scene::Source source;
+            JobSystem::Counter counter;
+            Stage stage = Stage::Reading;
+            bool activate = true;
+            bool read_ok = false;
+            u32 assets_begin = 0;
+        };
+
+        f32 get_progress(const Request& request) const;
+
+        std::vector<std::unique_ptr<Request>> requests;
+    };
+}
@@ -0,0 +1,144 @@
+#include "scene_snapshot.hpp"
+
+#include <unordered_set>
+
+#include "scene.hpp"
+#include "scene_object.hpp"
+
+namespace link
+{
+    namespace
+    {
+        inline u64 handle_key(Handle handle)
+        {
+            return ((u64)handle.index << 32) | handle.generation;
+        }
+    }
+
+    void SceneSnapshot::capture(Scene& scene)
+    {
+        writer = BinaryWriter();
+        strings.clear();
+        objects.clear();
+        components.clear();
+
+        // objects are recorded in dense order, the parent indices written by the transforms match the record indices
+        for (u32 i = 0; i < scene.scene_objects.size(); ++i)
+        {
+            SceneObject* obj = scene.scene_objects[i].get();
+
+            ObjectRecord object{ obj->handle, writer.intern(obj->name.value), (u32)components.size(), 0, obj->prefab };
+            for (auto& kv : obj->components)
+            {
+                ComponentRecord component{ kv.second->type, writer.get_position(), 0 };
+                kv.second->to_binary(writer);
+                component.size = writer.get_position() - component.offset;
+
+                components.push_back(component);
+                object.component_count++;
+            }
+            objects.push_back(object);
+        }
+
+        writer.write_string_table(strings);
+        captured = true;
+    }
+
+    void SceneSnapshot::clear()
+    {
+        writer = BinaryWriter();
+        strings.clear();
+        objects.clear();
+        components.clear();
+        captured = false;
+    }
+
+    void SceneSnapshot::restore(Scene& scene)
+    {
+        BinaryReader string_table;
+        string_table.init_string_table(strings.data(), (u32)strings.size());
+
+        // objects created while playing
+        std::unordered_set<u64> captured;
+        for (const ObjectRecord& object : objects)
+        {
+            captured.insert(handle_key(object.handle));
+        }
+        for (u32 i = scene.scene_objects.size(); i-- > 0;)
+        {
+            const Handle handle = scene.scene_objects.get_handle(i);
+            if (captured.find(handle_key(handle)) == captured.end())
+            {
+                scene.scene_objects.remove(handle);
+            }
+        }
+        scene.destroy_queue.clear();
+
+        std::vector<SceneObject*> restored;
+        restored.reserve(objects.size());
+        for (const ObjectRecord& object : objects)
+        {
+            const std::string name(string_table.get_string(object.name));
+
+            // objects destroyed while playing are the only ones created again
+            SceneObject* obj = scene.get(object.handle);
+            if (!obj)
+            {
+                obj = scene.create_object(name);
+            }
+            obj->name.set(name);
+            obj->prefab = object.prefab;
+
+            // components added while playing
+            std::vector<Component*> added;
+            for (auto& kv : obj->components)
+            {
+                if (!has_component(object, kv.second->type))
+                {
+                    added.push_back(kv.second.get());
+                }
+            }
+            for (Component* component : added)
+            {
+                obj->remove(component);
+            }
+
+            for (u32 c = object.first_component; c < object.first_component + object.component_count; ++c)
+            {
+                if (!Component::find_in(obj, components[c].type))
+                {
+                    Component::add_to(obj, components[c].type);
+                }
+            }
+            restored.push_back(obj);
+        }
+
+        for (u32 i = 0; i < objects.size(); ++i)
+        {
+            const ObjectRecord& object = objects[i];
+            for (u32 c = object.first_component; c < object.first_component + object.component_count; ++c)
+            {
+                Component* component = Component::find_in(restored[i], components[c].type);
+                BinaryReader reader(writer.buffer.data() + components[c].offset, components[c].size, &string_table);
+
+                component->refresh_dependencies();
+                component->from_binary(reader);
+            }
+        }
+
+        scene.resolve_parents(restored);
+        scene.set_components_dirty();
+    }
+
+    bool SceneSnapshot::has_component(const ObjectRecord& object, Component::Type type) const
+    {
+        for (u32 c = object.first_component; c < object.first_component + object.component_count; ++c)
+        {
+            if (components[c].type == type)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "link/types.hpp"
+#include "link/handle.hpp"
+#include "link/binary.hpp"
+#include "component.hpp"
+
+namespace link
+{
+    struct Scene;
+    struct Prefab;
+
+    // In memory copy of the state of every component of a scene, taken when entering play mode.
+    // Restoring it works in place : objects and components that survived play mode are only refilled,
+    // resources already loaded (shaders, models, textures) are kept as long as their path did not change.
+    struct SceneSnapshot
+    {
+        void capture(Scene& scene);
+        void restore(Scene& scene);
+        void clear();
+
+        inline bool empty() const { return objects.empty(); }
+        inline bool is_captured() const { return captured; }
+
+    private:
+        struct ObjectRecord
+        {
+            Handle handle;
+            u32 name;               // string index
+            u32 first_component;
+            u32 component_count;
+            const Prefab* prefab;
+        };
+
+        struct ComponentRecord
+        {
+            Component::Type type;
+            u32 offset;
+            u32 size;
+        };
+
+        bool has_component(const ObjectRecord& object, Component::Type type) const;
+
+        BinaryWriter writer;
+        std::vector<u8> strings;
+        std::vector<ObjectRecord> objects;
+        std::vector<ComponentRecord> components;
+        bool captured = false;
+    };
+}
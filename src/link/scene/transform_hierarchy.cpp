@@ -0,0 +1,424 @@
+#include "transform_hierarchy.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/quaternion.hpp>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define LINK_TRANSFORM_SSE
+#include <xmmintrin.h>
+#endif
+
+#include "components/c_transform.hpp"
+
+namespace link
+{
+    void TransformSoA::resize(u32 count)
+    {
+        const u32 padded = (count + BATCH_SIZE - 1) / BATCH_SIZE * BATCH_SIZE;
+
+        // padding lanes hold an identity transform
+        for (std::vector<f32>* array : { &position_x, &position_y, &position_z, &rotation_x, &rotation_y, &rotation_z })
+        {
+            array->assign(padded, 0.0f);
+        }
+        for (std::vector<f32>* array : { &rotation_w, &scale_x, &scale_y, &scale_z })
+        {
+            array->assign(padded, 1.0f);
+        }
+    }
+
+    void TransformSoA::set(u32 index, const glm::vec3& position, const glm::vec3& euler, const glm::vec3& scale)
+    {
+        // same rotation order as the editor values : x, then y, then z
+        const glm::quat rotation = glm::angleAxis(euler.x, glm::vec3(1, 0, 0))
+            * glm::angleAxis(euler.y, glm::vec3(0, 1, 0))
+            * glm::angleAxis(euler.z, glm::vec3(0, 0, 1));
+
+        position_x[index] = position.x;
+        position_y[index] = position.y;
+        position_z[index] = position.z;
+        rotation_x[index] = rotation.x;
+        rotation_y[index] = rotation.y;
+        rotation_z[index] = rotation.z;
+        rotation_w[index] = rotation.w;
+        scale_x[index] = scale.x;
+        scale_y[index] = scale.y;
+        scale_z[index] = scale.z;
+    }
+
+#ifdef LINK_TRANSFORM_SSE
+    void TransformSoA::compute_local_matrices(u32 first, glm::mat4* out) const
+    {
+        const __m128 x = _mm_loadu_ps(&rotation_x[first]);
+        const __m128 y = _mm_loadu_ps(&rotation_y[first]);
+        const __m128 z = _mm_loadu_ps(&rotation_z[first]);
+        const __m128 w = _mm_loadu_ps(&rotation_w[first]);
+        const __m128 sx = _mm_loadu_ps(&scale_x[first]);
+        const __m128 sy = _mm_loadu_ps(&scale_y[first]);
+        const __m128 sz = _mm_loadu_ps(&scale_z[first]);
+
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+        // rows of each rotated and scaled column, one lane per transform
+        __m128 c0r0 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+        __m128 c0r1 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+        __m128 c0r2 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+        __m128 c0r3 = zero;
+
+        __m128 c1r0 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+        __m128 c1r1 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+        __m128 c1r2 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+        __m128 c1r3 = zero;
+
+        __m128 c2r0 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+        __m128 c2r1 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+        __m128 c2r2 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+        __m128 c2r3 = zero;
+
+        __m128 c3r0 = _mm_loadu_ps(&position_x[first]);
+        __m128 c3r1 = _mm_loadu_ps(&position_y[first]);
+        __m128 c3r2 = _mm_loadu_ps(&position_z[first]);
+        __m128 c3r3 = one;
+
+        // after the transposes, register i holds that column of matrix first + i
+        _MM_TRANSPOSE4_PS(c0r0, c0r1, c0r2, c0r3);
+        _MM_TRANSPOSE4_PS(c1r0, c1r1, c1r2, c1r3);
+        _MM_TRANSPOSE4_PS(c2r0, c2r1, c2r2, c2r3);
+        _MM_TRANSPOSE4_PS(c3r0, c3r1, c3r2, c3r3);
+
+        const __m128 columns[4][4] =
+        {
+            { c0r0, c1r0, c2r0, c3r0 },
+            { c0r1, c1r1, c2r1, c3r1 },
+            { c0r2, c1r2, c2r2, c3r2 },
+            { c0r3, c1r3, c2r3, c3r3 },
+        };
+
+        for (u32 i = 0; i < BATCH_SIZE; ++i)
+        {
+            f32* matrix = &out[i][0][0];
+            _mm_storeu_ps(matrix + 0, columns[i][0]);
+            _mm_storeu_ps(matrix + 4, columns[i][1]);
+            _mm_storeu_ps(matrix + 8, columns[i][2]);
+            _mm_storeu_ps(matrix + 12, columns[i][3]);
+        }
+    }
+#else
+    void TransformSoA::compute_local_matrices(u32 first, glm::mat4* out) const
+    {
+        for (u32 i = 0; i < BATCH_SIZE; ++i)
+        {
+            const u32 index = first + i;
+            const glm::quat rotation(rotation_w[index], rotation_x[index], rotation_y[index], rotation_z[index]);
+            const glm::mat3 basis = glm::mat3_cast(rotation);
+
+            glm::mat4& matrix = out[i];
+            matrix[0] = glm::vec4(basis[0] * scale_x[index], 0.0f);
+            matrix[1] = glm::vec4(basis[1] * scale_y[index], 0.0f);
+            matrix[2] = glm::vec4(basis[2] * scale_z[index], 0.0f);
+            matrix[3] = glm::vec4(position_x[index], position_y[index], position_z[index], 1.0f);
+        }
+    }
+#endif
+
+    namespace
+    {
+        inline void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+        {
+#ifdef LINK_TRANSFORM_SSE
+            const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+            const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+            const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+            const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+            for (u32 column = 0; column < 4; ++column)
+            {
+                __m128 result = _mm_mul_ps(a0, _mm_set1_ps(b[column][0]));
+                result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(b[column][1])));
+                result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(b[column][2])));
+                result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(b[column][3])));
+                _mm_storeu_ps(&out[column][0], result);
+            }
+#else
+            out = a * b;
+#endif
+        }
+    }
+
+    TransformHierarchy::TransformHierarchy()
+        : dirty(false)
+        , order_dirty(false)
+    {
+    }
+
+    void TransformHierarchy::add(CTransform* transform)
+    {
+        transform->hierarchy = this;
+        transform->hierarchy_index = (u32)transforms.size();
+        transforms.push_back(transform);
+        order_dirty = true;
+    }
+
+    void TransformHierarchy::remove(CTransform* transform)
+    {
+        set_parent(transform, nullptr);
+        for (CTransform* child : transform->children)
+        {
+            // orphans keep their local values and become roots
+            child->parent = nullptr;
+        }
+        transform->children.clear();
+
+        const u32 index = transform->hierarchy_index;
+        if (index < transforms.size() && transforms[index] == transform)
+        {
+            transforms[index] = transforms.back();
+            transforms[index]->hierarchy_index = index;
+            transforms.pop_back();
+        }
+        transform->hierarchy_index = U32_INVALID;
+        transform->order_index = U32_INVALID;
+
+        order_dirty = true;
+    }
+
+    bool TransformHierarchy::set_parent(CTransform* child, CTransform* parent)
+    {
+        if (child->parent == parent)
+        {
+            return true;
+        }
+
+        for (CTransform* ancestor = parent; ancestor; ancestor = ancestor->parent)
+        {
+            if (ancestor == child)
+            {
+                return false;
+            }
+        }
+
+        if (child->parent)
+        {
+            std::vector<CTransform*>& siblings = child->parent->children;
+            siblings.erase(std::find(siblings.begin(), siblings.end(), child));
+        }
+
+        child->parent = parent;
+        if (parent)
+        {
+            parent->children.push_back(child);
+        }
+
+        order_dirty = true;
+        return true;
+    }
+
+    void TransformHierarchy::set_dirty(u32 order_index)
+    {
+        if (order_index < dirty_flags.size())
+        {
+            dirty_flags[order_index] = 1;
+        }
+        dirty.store(true, std::memory_order_relaxed);
+    }
+
+    const glm::mat4& TransformHierarchy::get_world_matrix(u32 order_index) const
+    {
+        static const glm::mat4 identity(1.0f);
+        return order_index < world_matrices.size() ? world_matrices[order_index] : identity;
+    }
+
+    const glm::mat4& TransformHierarchy::get_render_matrix(u32 order_index) const
+    {
+        return order_index < render_matrices.size() ? render_matrices[order_index] : get_world_matrix(order_index);
+    }
+
+    const glm::mat4& TransformHierarchy::get_local_matrix(u32 order_index) const
+    {
+        static const glm::mat4 identity(1.0f);
+        return order_index < order.size() ? local_matrices[order_index] : identity;
+    }
+
+    bool TransformHierarchy::update()
+    {
+        if (!dirty.load(std::memory_order_relaxed) && !order_dirty)
+        {
+            return false;
+        }
+        dirty.store(false, std::memory_order_relaxed);
+
+        if (order_dirty)
+        {
+            rebuild_order();
+        }
+
+        const u32 count = (u32)order.size();
+
+        // pull the edited values of dirty transforms into the SoA arrays
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (dirty_flags[i])
+            {
+                const CTransform* transform = order[i];
+                locals.set(i, transform->position, transform->rotation, transform->scale);
+            }
+        }
+
+        // a batch is recomputed as soon as one of its transforms is dirty
+        for (u32 first = 0; first < count; first += TransformSoA::BATCH_SIZE)
+        {
+            u32 batch_flags;
+            std::memcpy(&batch_flags, &dirty_flags[first], sizeof(batch_flags));
+            if (batch_flags)
+            {
+                locals.compute_local_matrices(first, &local_matrices[first]);
+            }
+        }
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            const u32 parent = parents[i];
+            const bool parent_changed = parent != U32_INVALID && changed[parent];
+
+            if (!dirty_flags[i] && !parent_changed)
+            {
+                changed[i] = 0;
+                continue;
+            }
+
+            if (parent != U32_INVALID)
+            {
+                multiply(world_matrices[parent], local_matrices[i], world_matrices[i]);
+            }
+            else
+            {
+                world_matrices[i] = local_matrices[i];
+            }
+            dirty_flags[i] = 0;
+            changed[i] = 1;
+        }
+        return true;
+    }
+
+    void TransformHierarchy::begin_step()
+    {
+        previous_matrices = world_matrices;
+    }
+
+    void TransformHierarchy::interpolate(f32 alpha)
+    {
+        const u32 count = (u32)world_matrices.size();
+        if (previous_matrices.size() != count)
+        {
+            snap();
+            return;
+        }
+
+        render_matrices.resize(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            const glm::mat4& previous = previous_matrices[i];
+            const glm::mat4& current = world_matrices[i];
+
+            if (std::memcmp(&previous, &current, sizeof(glm::mat4)) == 0)
+            {
+                render_matrices[i] = current;
+                continue;
+            }
+
+            // blending the matrices directly would shear rotations : translation and scale are lerped, rotation slerped
+            glm::vec3 previous_scale(glm::length(glm::vec3(previous[0])), glm::length(glm::vec3(previous[1])), glm::length(glm::vec3(previous[2])));
+            glm::vec3 current_scale(glm::length(glm::vec3(current[0])), glm::length(glm::vec3(current[1])), glm::length(glm::vec3(current[2])));
+
+            // a collapsed axis has no rotation to extract (shrink to zero, flattened decals), the matrices are blended as they are
+            constexpr f32 MIN_SCALE = 1e-6f;
+            if (glm::any(glm::lessThan(glm::min(previous_scale, current_scale), glm::vec3(MIN_SCALE))))
+            {
+                render_matrices[i] = previous + (current - previous) * alpha;
+                continue;
+            }
+
+            // a mirrored matrix would normalise to a reflection, not a rotation : its x scale is made negative,
+            // and a mirror flipping between two ticks is blended as it is
+            const bool previous_mirrored = glm::determinant(glm::mat3(previous)) < 0.0f;
+            const bool current_mirrored = glm::determinant(glm::mat3(current)) < 0.0f;
+            if (previous_mirrored != current_mirrored)
+            {
+                render_matrices[i] = previous + (current - previous) * alpha;
+                continue;
+            }
+            if (current_mirrored)
+            {
+                previous_scale.x = -previous_scale.x;
+                current_scale.x = -current_scale.x;
+            }
+
+            const glm::quat previous_rotation = glm::quat_cast(glm::mat3(glm::vec3(previous[0]) / previous_scale.x, glm::vec3(previous[1]) / previous_scale.y, glm::vec3(previous[2]) / previous_scale.z));
+            const glm::quat current_rotation = glm::quat_cast(glm::mat3(glm::vec3(current[0]) / current_scale.x, glm::vec3(current[1]) / current_scale.y, glm::vec3(current[2]) / current_scale.z));
+
+            const glm::vec3 scale = glm::mix(previous_scale, current_scale, alpha);
+            glm::mat4 blended = glm::mat4_cast(glm::slerp(previous_rotation, current_rotation, alpha));
+            blended[0] *= scale.x;
+            blended[1] *= scale.y;
+            blended[2] *= scale.z;
+            blended[3] = glm::mix(previous[3], current[3], alpha);
+            render_matrices[i] = blended;
+        }
+    }
+
+    void TransformHierarchy::snap()
+    {
+        previous_matrices.clear();
+        render_matrices.clear();
+    }
+
+    void TransformHierarchy::rebuild_order()
+    {
+        order.clear();
+        parents.clear();
+
+        for (CTransform* transform : transforms)
+        {
+            if (!transform->parent)
+            {
+                order.push_back(transform);
+                parents.push_back(U32_INVALID);
+            }
+        }
+
+        // order doubles as the breadth first queue
+        for (u32 i = 0; i < order.size(); ++i)
+        {
+            for (CTransform* child : order[i]->children)
+            {
+                order.push_back(child);
+                parents.push_back(i);
+            }
+        }
+
+        const u32 count = (u32)order.size();
+        for (u32 i = 0; i < count; ++i)
+        {
+            order[i]->order_index = i;
+        }
+
+        // indices moved, everything is recomputed once
+        locals.resize(count);
+        const u32 padded = (u32)locals.position_x.size();
+        local_matrices.assign(padded, glm::mat4(1.0f));
+        world_matrices.assign(count, glm::mat4(1.0f));
+        dirty_flags.assign(padded, 0);
+        std::fill(dirty_flags.begin(), dirty_flags.begin() + count, (u8)1);
+        changed.assign(count, 0);
+        snap();
+
+        order_dirty = false;
+    }
+}
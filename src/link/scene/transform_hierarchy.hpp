@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <glm/glm.hpp>
+
+#include "link/types.hpp"
+
+namespace link
+{
+    struct CTransform;
+
+    // Local position / rotation / scale of every transform in structure of arrays form,
+    // padded to a multiple of BATCH_SIZE so the batch kernel never needs a scalar tail.
+    struct TransformSoA
+    {
+        static constexpr u32 BATCH_SIZE = 4;
+
+        void resize(u32 count);
+        void set(u32 index, const glm::vec3& position, const glm::vec3& euler, const glm::vec3& scale);
+
+        // writes BATCH_SIZE local matrices starting at first, first has to be a multiple of BATCH_SIZE
+        void compute_local_matrices(u32 first, glm::mat4* out) const;
+
+        std::vector<f32> position_x, position_y, position_z;
+        std::vector<f32> rotation_x, rotation_y, rotation_z, rotation_w;
+        std::vector<f32> scale_x, scale_y, scale_z;
+    };
+
+    // Every transform of a scene, flattened breadth first so parents always come before their children.
+    // Local matrices are rebuilt in batches from the SoA data, world matrices are only recomputed for dirty
+    // transforms and the subtrees below them and live in one contiguous array the renderer can upload as is.
+    // A scene where nothing moved costs a single flag check.
+    struct TransformHierarchy
+    {
+        TransformHierarchy();
+
+        void add(CTransform* transform);
+        void remove(CTransform* transform);
+        // returns false if parent is child itself or one of its descendants
+        bool set_parent(CTransform* child, CTransform* parent);
+        // returns false when nothing moved, changed is only meaningful after a true
+        bool update();
+
+        // may be called from update systems running on worker threads, each transform only touches its own flag
+        void set_dirty(u32 order_index);
+
+        // world matrices of the last simulation step become the previous state, call before the step runs
+        void begin_step();
+        // blends the previous and current world matrices into the render matrices, alpha in [0, 1]
+        void interpolate(f32 alpha);
+        // drops the previous state, render matrices are the world matrices until the next begin_step
+        void snap();
+
+        const glm::mat4& get_world_matrix(u32 order_index) const;
+        const glm::mat4& get_render_matrix(u32 order_index) const;
+        const glm::mat4& get_local_matrix(u32 order_index) const;
+
+        inline const glm::mat4* get_world_matrices() const { return world_matrices.data(); }
+        inline u32 get_count() const { return (u32)order.size(); }
+
+        std::vector<CTransform*>    transforms;     // unordered, CTransform::hierarchy_index points in here
+        std::vector<CTransform*>    order;          // breadth first, CTransform::order_index points in here
+        std::vector<u32>            parents;        // index in order of the parent, U32_INVALID for roots
+
+        TransformSoA                locals;
+        std::vector<glm::mat4>      local_matrices; // padded like locals
+        std::vector<glm::mat4>      world_matrices;
+        std::vector<u8>             dirty_flags;    // padded like locals, local values changed since the last update
+        std::vector<u8>             changed;        // world matrix recomputed during the current update
+        std::vector<glm::mat4>      previous_matrices;  // world matrices at the start of the last step, empty when snapped
+        std::vector<glm::mat4>      render_matrices;    // empty when snapped
+
+        std::atomic<bool>           dirty;
+        bool                        order_dirty;
+
+    private:
+        void rebuild_order();
+    };
+}
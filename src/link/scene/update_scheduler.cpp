@@ -0,0 +1,106 @@
+#include "update_scheduler.hpp"
+
+#include <algorithm>
+
+#include "scene.hpp"
+#include "link/job_system.hpp"
+
+namespace link
+{
+    void UpdateScheduler::add(UpdateSystem system)
+    {
+        systems.emplace_back(std::move(system));
+        build_phases();
+    }
+
+    bool UpdateScheduler::conflicts(const UpdateSystem& a, const UpdateSystem& b)
+    {
+        const ComponentMask a_touches = a.reads | a.writes;
+        const ComponentMask b_touches = b.reads | b.writes;
+        return (a.writes & b_touches) != 0 || (b.writes & a_touches) != 0;
+    }
+
+    void UpdateScheduler::build_phases()
+    {
+        phases.clear();
+
+        std::vector<u32> phase_of(systems.size(), 0);
+        for (u32 i = 0; i < systems.size(); ++i)
+        {
+            for (u32 j = 0; j < i; ++j)
+            {
+                if (conflicts(systems[i], systems[j]))
+                {
+                    phase_of[i] = std::max(phase_of[i], phase_of[j] + 1);
+                }
+            }
+
+            if (phase_of[i] >= phases.size())
+            {
+                phases.resize(phase_of[i] + 1);
+            }
+            phases[phase_of[i]].push_back(i);
+        }
+    }
+
+    void UpdateScheduler::run(Scene& scene)
+    {
+        scene.refresh_component_lists();
+
+        for (const std::vector<u32>& phase : phases)
+        {
+            if (!parallel)
+            {
+                for (u32 index : phase)
+                {
+                    run_system(systems[index], scene.get_components(systems[index].type));
+                }
+                continue;
+            }
+
+            JobSystem::Counter counter;
+
+            for (u32 index : phase)
+            {
+                const UpdateSystem& system = systems[index];
+                if (system.main_thread_only)
+                {
+                    continue;
+                }
+
+                std::vector<Component*>& components = scene.get_components(system.type);
+                const u32 count = (u32)components.size();
+                for (u32 begin = 0; begin < count; begin += chunk_size)
+                {
+                    const u32 end = std::min(begin + chunk_size, count);
+                    LINK_JOBS->run(counter, [&system, &components, begin, end]()
+                    {
+                        for (u32 i = begin; i < end; ++i)
+                        {
+                            system.function(components[i]);
+                        }
+                    });
+                }
+            }
+
+            // main thread systems overlap with the workers, they do not conflict with anything in this phase
+            for (u32 index : phase)
+            {
+                if (systems[index].main_thread_only)
+                {
+                    run_system(systems[index], scene.get_components(systems[index].type));
+                }
+            }
+
+            LINK_JOBS->wait(counter);
+        }
+    }
+
+    void UpdateScheduler::run_system(const UpdateSystem& system, std::vector<Component*>& components)
+    {
+        for (Component* component : components)
+        {
+            system.function(component);
+        }
+    }
+}
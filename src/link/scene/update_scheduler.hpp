@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "link/types.hpp"
+#include "component.hpp"
+
+namespace link
+{
+    struct Scene;
+
+    using ComponentMask = u32;
+
+    inline constexpr ComponentMask component_mask(Component::Type type)
+    {
+        return 1u << (u32)type;
+    }
+
+    // An update system iterates every component of one type in a scene.
+    // reads/writes declare which component types the function touches; the function may only
+    // access components owned by the same scene object as the component it is called on.
+    // Systems touching global state that is not thread safe (physics world, gl) have to be
+    // flagged main_thread_only. Debug draw is safe from any system.
+    struct UpdateSystem
+    {
+        using Function = std::function<void(Component* component)>;
+
+        std::string     name;
+        Component::Type type;
+        ComponentMask   reads = 0;
+        ComponentMask   writes = 0;
+        bool            main_thread_only = false;
+        Function        function;
+    };
+
+    // Groups systems in phases where no two systems conflict. A system lands in the phase after
+    // the last earlier-registered system it conflicts with, so the result is the same as running
+    // the systems one after the other in registration order.
+    struct UpdateScheduler
+    {
+        void add(UpdateSystem system);
+        void run(Scene& scene);
+
+        static bool conflicts(const UpdateSystem& a, const UpdateSystem& b);
+
+        std::vector<UpdateSystem>       systems;
+        std::vector<std::vector<u32>>   phases;
+        u32                             chunk_size = 64;
+        bool                            parallel = true;
+
+    private:
+        void build_phases();
+        void run_system(const UpdateSystem& system, std::vector<Component*>& components);
+    };
+}
@@ -0,0 +1,248 @@
+#include "world_streamer.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fmt/ostream.h>
+#include <json.hpp>
+
+#ifdef LINK_EDITOR_ENABLED
+#include <imgui.h>
+#endif
+
+#include "link/file.hpp"
+#include "scene.hpp"
+#include "scene_loader.hpp"
+
+namespace link
+{
+    namespace
+    {
+#ifdef LINK_EDITOR_ENABLED
+        const char* state_name(Scene::State state)
+        {
+            switch (state)
+            {
+            case Scene::State::Unloaded:    return "Unloaded";
+            case Scene::State::Loading:     return "Loading";
+            case Scene::State::Resident:    return "Resident";
+            case Scene::State::Active:      return "Active";
+            default:                        return "";
+            }
+        }
+#endif
+
+        glm::vec3 read_vec3(const nlohmann::json& j, const char* key)
+        {
+            if (!j.contains(key))
+            {
+                return glm::vec3(0.0f);
+            }
+            const nlohmann::json& value = j[key];
+            return { value[0].get<f32>(), value[1].get<f32>(), value[2].get<f32>() };
+        }
+    }
+
+    bool WorldStreamer::load(const std::string& path)
+    {
+        using nlohmann::json;
+
+        volumes.clear();
+        if (!File::exists(path))
+        {
+            return false;
+        }
+
+        std::string content;
+        File2::read(path, content);
+        json j = json::parse(content, nullptr, false);
+        if (j.is_discarded())
+        {
+            fmt::print("Cannot parse world {}\n", path);
+            return false;
+        }
+
+        if (j.contains("memory_budget_mb"))
+        {
+            memory_budget = j["memory_budget_mb"].get<u64>() * 1024 * 1024;
+        }
+
+        for (const json& j_volume : j["scenes"])
+        {
+            Volume volume;
+            volume.scene_name = std::filesystem::path(j_volume["scene"].get<std::string>()).stem().string();
+            volume.center = read_vec3(j_volume, "center");
+            volume.extents = read_vec3(j_volume, "extents");
+            volume.load_distance = j_volume.value("load_distance", 0.0f);
+            volume.unload_distance = std::max(j_volume.value("unload_distance", 0.0f), volume.load_distance);
+            volumes.push_back(volume);
+        }
+
+        fmt::print("Loaded world {} : {} streamed scenes\n", path, volumes.size());
+        return true;
+    }
+
+    void WorldStreamer::bind(std::vector<std::unique_ptr<Scene>>& all_scenes)
+    {
+        scenes.clear();
+        for (auto& scene : all_scenes)
+        {
+            scenes.push_back(scene.get());
+        }
+
+        for (Volume& volume : volumes)
+        {
+            volume.scene = nullptr;
+            for (Scene* scene : scenes)
+            {
+                if (std::filesystem::path(scene->path).stem().string().compare(volume.scene_name) == 0)
+                {
+                    volume.scene = scene;
+                    break;
+                }
+            }
+
+            if (!volume.scene)
+            {
+                fmt::print("World : no scene file for {}\n", volume.scene_name);
+            }
+        }
+    }
+
+    bool WorldStreamer::is_streamed(const Scene& scene) const
+    {
+        const std::string name = std::filesystem::path(scene.path).stem().string();
+        return std::any_of(volumes.begin(), volumes.end(), [&name](const Volume& volume)
+        {
+            return volume.scene_name.compare(name) == 0;
+        });
+    }
+
+    f32 WorldStreamer::distance_to(const Volume& volume, const glm::vec3& point)
+    {
+        // zero when inside the box
+        const glm::vec3 outside = glm::max(glm::abs(point - volume.center) - volume.extents, glm::vec3(0.0f));
+        return glm::length(outside);
+    }
+
+    void WorldStreamer::update(const glm::vec3& viewer, SceneLoader& loader)
+    {
+        for (Volume& volume : volumes)
+        {
+            Scene* scene = volume.scene;
+            if (!scene)
+            {
+                continue;
+            }
+
+            volume.distance = distance_to(volume, viewer);
+            const bool in_load_range = volume.distance <= volume.load_distance;
+            const bool in_keep_range = volume.distance <= volume.unload_distance;
+
+            switch (scene->state)
+            {
+            case Scene::State::Unloaded:
+                if (in_keep_range)
+                {
+                    loader.request(*scene, in_load_range);
+                }
+                break;
+
+            case Scene::State::Loading:
+                if (in_load_range)
+                {
+                    loader.request(*scene, true);
+                }
+                break;
+
+            case Scene::State::Resident:
+                if (in_load_range)
+                {
+                    scene->state = Scene::State::Active;
+                }
+                break;
+
+            case Scene::State::Active:
+                if (!in_keep_range)
+                {
+                    scene->state = Scene::State::Resident;
+                }
+                break;
+            }
+        }
+
+        enforce_budget();
+    }
+
+    u64 WorldStreamer::get_memory_usage() const
+    {
+        u64 usage = 0;
+        for (Scene* scene : scenes)
+        {
+            if (scene->is_loaded())
+            {
+                usage += scene->memory_usage;
+            }
+        }
+        return usage;
+    }
+
+    void WorldStreamer::enforce_budget()
+    {
+        u64 usage = get_memory_usage();
+        if (usage <= memory_budget)
+        {
+            return;
+        }
+
+        // furthest resident scenes go first, active ones are never unloaded for the budget
+        std::vector<Volume*> candidates;
+        for (Volume& volume : volumes)
+        {
+            if (volume.scene && volume.scene->state == Scene::State::Resident)
+            {
+                candidates.push_back(&volume);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Volume* a, const Volume* b)
+        {
+            return a->distance > b->distance;
+        });
+
+        for (Volume* volume : candidates)
+        {
+            if (usage <= memory_budget)
+            {
+                break;
+            }
+
+            usage -= volume->scene->memory_usage;
+            fmt::print("World : unloading {} for the memory budget\n", volume->scene_name);
+            volume->scene->unload();
+        }
+    }
+
+#ifdef LINK_EDITOR_ENABLED
+    void WorldStreamer::debug_draw()
+    {
+        if (volumes.empty())
+        {
+            return;
+        }
+
+        if (ImGui::Begin("World"))
+        {
+            ImGui::Text("Memory %.1f / %.1f MB", get_memory_usage() / (1024.0 * 1024.0), memory_budget / (1024.0 * 1024.0));
+            ImGui::Separator();
+            for (const Volume& volume : volumes)
+            {
+                ImGui::Text("%-24s %-10s %8.1f m  %8.2f MB",
+                    volume.scene_name.c_str(),
+                    volume.scene ? state_name(volume.scene->state) : "Missing",
+                    volume.distance,
+                    volume.scene ? volume.scene->memory_usage / (1024.0 * 1024.0) : 0.0);
+            }
+            ImGui::End();
+        }
+    }
+#endif
+}
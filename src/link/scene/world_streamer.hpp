@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <glm/glm.hpp>
+
+#include "link/types.hpp"
+#include "link/editor/editor.hpp"
+
+namespace link
+{
+    struct Scene;
+    struct SceneLoader;
+
+    // Streams the scenes of a world around a viewer, driven by an optional world.json next to the scenes :
+    // {
+    //     "memory_budget_mb" : 512,
+    //     "scenes" : [ { "scene" : "forest", "center" : [0, 0, 0], "extents" : [50, 20, 50],
+    //                    "load_distance" : 30, "unload_distance" : 60 } ]
+    // }
+    // extents describe a trigger box around center, left out the volume is a single point.
+    // Within load_distance of the volume the scene is active, within unload_distance it is kept (or prefetched)
+    // as resident, further away it stays resident until the memory budget needs the room.
+    // Scenes not listed in the world are not streamed, they are loaded and active from the start.
+    struct WorldStreamer
+    {
+        struct Volume
+        {
+            std::string scene_name;
+            Scene* scene = nullptr;
+            glm::vec3 center{ 0.0f };
+            glm::vec3 extents{ 0.0f };
+            f32 load_distance = 0.0f;
+            f32 unload_distance = 0.0f;
+            f32 distance = 0.0f;    // from the viewer, last update
+        };
+
+        bool load(const std::string& path);
+        void bind(std::vector<std::unique_ptr<Scene>>& scenes);
+        bool is_streamed(const Scene& scene) const;
+
+        void update(const glm::vec3& viewer, SceneLoader& loader);
+        u64 get_memory_usage() const;
+
+        std::vector<Volume> volumes;
+        std::vector<Scene*> scenes;
+        u64 memory_budget = 512ull * 1024 * 1024;
+
+#ifdef LINK_EDITOR_ENABLED
+        void debug_draw();
+#else
+        inline void debug_draw() {}
+#endif
+
+    private:
+        static f32 distance_to(const Volume& volume, const glm::vec3& point);
+        void enforce_budget();
+    };
+}
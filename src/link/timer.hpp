@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+
 #include "SDL.h"
 
 #include "types.hpp"
@@ -46,9 +48,59 @@ namespace link
         }
     };
 
+    // Accumulates frame time and hands it out in steps of a fixed duration.
+    // A frame runs at most max_steps steps, time beyond that is dropped so a slow frame cannot snowball
+    // into ever longer ones. alpha is how far the frame sits between the last two steps, for interpolation.
+    struct FixedTimestep
+    {
+        f64 step_s = 1.0 / 60.0;
+        f64 accumulator_s = 0.0;
+        f64 dropped_s = 0.0;
+        f32 alpha = 0.0f;
+        u32 max_steps = 5;
+
+        void set_rate(f64 steps_per_second)
+        {
+            step_s = 1.0 / steps_per_second;
+            reset();
+        }
+
+        void reset()
+        {
+            accumulator_s = 0.0;
+            dropped_s = 0.0;
+            alpha = 0.0f;
+        }
+
+        // returns the number of steps to run this frame
+        u32 advance(f64 frame_s)
+        {
+            accumulator_s += frame_s;
+
+            u32 steps = 0;
+            while (accumulator_s >= step_s && steps < max_steps)
+            {
+                accumulator_s -= step_s;
+                steps++;
+            }
+
+            if (accumulator_s >= step_s)
+            {
+                const f64 kept = std::fmod(accumulator_s, step_s);
+                dropped_s += accumulator_s - kept;
+                accumulator_s = kept;
+            }
+
+            alpha = (f32)(accumulator_s / step_s);
+            return steps;
+        }
+    };
+
     struct GlobalTimer : Singleton<GlobalTimer>
     {
         Timer timer;
+        // simulation clock, game updates and physics advance by simulation.step_s
+        FixedTimestep simulation;
 
         void start()
         {